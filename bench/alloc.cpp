@@ -0,0 +1,81 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include "harness.hpp"
+#include "frame_alloc.hpp"
+
+// the measurements of allocating the frame buffer while the size of the frames keeps changing,
+// as when switching projects or taking in proxy-sized frames.
+
+using namespace bench;
+
+// writes a byte to every page, so the pages are actually committed as the frame is copied in.
+static void touch(void* p, size_t bytes)
+{
+	for (size_t i = 0; i < bytes; i += 4096) static_cast<volatile byte*>(p)[i] = 1;
+}
+
+BENCHMARK(alloc_churn)
+{
+	// the sizes of 24bpp frames cycled through, around the size measured.
+	for (auto const& size : suite.active_sizes({ "1080p", "4K", "8K" })) {
+		size_t const full = ImageView::stride_of(size.width) * size.height,
+			cycle[] = { full, full / 4, full, full / 2, full / 16, full };
+		size_t i = 0;
+		auto const next = [&] { auto const b = cycle[i]; i = (i + 1) % std::size(cycle); return b; };
+
+		// keeps the capacity and reuses the pages.
+		FrameAllocator retained{};
+		suite.measure(name({ "alloc/churn/frame_allocator", size.name }), 0, 0, [&] {
+			auto const bytes = next();
+			touch(retained.allocate(bytes), bytes);
+			retained.tick();
+		});
+
+		// releases the excess immediately, committing the pages again when growing back.
+		FrameAllocator eager{ 0 };
+		suite.measure(name({ "alloc/churn/no_retention", size.name }), 0, 0, [&] {
+			auto const bytes = next();
+			touch(eager.allocate(bytes), bytes);
+		});
+
+		// allocating each time, as the buffer did before the allocator.
+		FrameAllocator fresh{};
+		suite.measure(name({ "alloc/churn/release_each_time", size.name }), 0, 0, [&] {
+			auto const bytes = next();
+			fresh.release();
+			touch(fresh.allocate(bytes), bytes);
+		});
+
+		suite.measure(name({ "alloc/churn/malloc", size.name }), 0, 0, [&] {
+			auto const bytes = next();
+			void* p = std::malloc(bytes);
+			touch(p, bytes);
+			std::free(p);
+		});
+
+		// trimming after a large frame when the frames have stopped coming.
+		FrameAllocator idle{};
+		suite.measure(name({ "alloc/trim_on_idle", size.name }), 0, 0, [&] {
+			touch(idle.allocate(full), full);
+			touch(idle.allocate(full / 4), full / 4);
+			idle.trim();
+		});
+	}
+}
@@ -0,0 +1,62 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+
+
+
+
+#include <cstdint>
+#include <vector>
+
+#include "harness.hpp"
+#include "color_space.hpp"
+
+// the measurements of the lumas over a frame,
+// a pixel at a time against the span kernel by the SIMD lanes.
+
+using namespace bench;
+namespace cs = sigma_lib::color_space;
+
+// measures `scalar(r, g, b)` for each pixel and `span(bgr, dst, n)` for each row of `frame`.
+template<class T>
+static void measure_pair(Suite& suite, const char* space, const Size& size, const Image& frame, auto&& scalar, auto&& span)
+{
+	int const w = size.width, h = size.height;
+	double const pixels = double(w) * h;
+	std::vector<T> dst(w);
+	suite.measure(name({ "color_space", space, "scalar", size.name }), 3 * pixels, pixels, [&] {
+		for (int y = 0; y < h; y++) {
+			const byte* p = frame.view.row(y);
+			for (int x = 0; x < w; x++, p += 3) dst[x] = scalar(p[2], p[1], p[0]);
+			keep(dst.data());
+		}
+	});
+	suite.measure(name({ "color_space", space, "span", size.name }), 3 * pixels, pixels, [&] {
+		for (int y = 0; y < h; y++) {
+			span(frame.view.row(y), dst.data(), w);
+			keep(dst.data());
+		}
+	});
+}
+
+BENCHMARK(color_space)
+{
+	for (auto const& size : suite.active_sizes({ "1080p" })) {
+		auto const& frame = suite.frame(Kind::noise, size);
+		measure_pair<byte>(suite, "luma", size, frame,
+			[](byte r, byte g, byte b) { return static_cast<byte>(cs::color_luma(r, g, b) >> 8); }, cs::color_luma_span);
+
+	}
+}
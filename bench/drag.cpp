@@ -0,0 +1,107 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+#include <cstdint>
+#include <vector>
+
+#include "harness.hpp"
+#include "canvas.hpp"
+#include "upscale.hpp"
+#include "loupe_view.hpp"
+
+// the measurements of panning by dragging: each move drawn anew,
+// against shifting the previous drawing and filling only the exposed strips as compose_picture() does.
+
+using namespace bench;
+
+// a drag replayed; the moves of the picture in whole picture pixels, each a few screen pixels
+// in varying directions as a hand moves. it goes and comes back so it can repeat.
+static std::vector<std::pair<int, int>> drag_moves(int n, int count)
+{
+	std::vector<std::pair<int, int>> moves;
+	test_util::Rng rng{ 21 };
+	auto const step = [&] {
+		int const d = (1 + static_cast<int>(rng() % 8) + n - 1) / n;
+		return rng() % 2 != 0 ? d : -d;
+	};
+	for (int i = 0; i < count / 2; i++) moves.emplace_back(step(), step());
+	for (int i = count / 2; --i >= 0;) moves.emplace_back(-moves[i].first, -moves[i].second);
+	return moves;
+}
+
+// each measurement is of one mouse move.
+BENCHMARK(drag_scroll)
+{
+	constexpr uint32_t blank = 0x00336699;
+	for (auto const& size : suite.active_sizes({ "1080p", "4K" })) {
+		auto const& frame = suite.frame(Kind::noise, size);
+		Image dst{ size.width, size.height, 4 };
+		RasterCanvas canvas{ dst.view };
+		Upscaler upscaler{};
+		auto const rc = Rect::of_size(size.width, size.height);
+		double const pixels = double(size.width) * size.height;
+
+		for (int z : { 0, 4, 8, 12 }) {
+			LoupeZoom const zoom{ z, 0 };
+			int const n = zoom.scale_ratio_Q().first;
+			auto const moves = drag_moves(n, 64);
+
+			// draws the `area` of the window, either by stretching or by the upscaler.
+			auto const draw_area = [&](const Rect& area, const Rect& vb, const Rect& vp, bool upscale) {
+				canvas.fill_rect(area, blank);
+				if (!upscale) canvas.stretch_image(vp, frame.view, vb);
+				else if (auto const& out = upscaler.render(frame.view, vb, vp, area); out.width > 0)
+					canvas.draw_image(std::max(vp.left, area.left), std::max(vp.top, area.top), out);
+			};
+			auto const measure = [&](const char* method, bool upscale, bool reuse) {
+				double x = size.width / 2.0 + 0.5, y = size.height / 2.0 + 0.5;
+				auto const view_at = [&] {
+					return viewbox_viewport(zoom, x, y, size.width, size.height, size.width, size.height);
+				};
+				auto [vb, vp] = view_at();
+				draw_area(rc, vb, vp, upscale);
+				size_t i = 0;
+				suite.measure(name({ "drag", method, upscale ? "upscaler" : "stretch", scale_label(zoom.scale_ratio()), size.name }),
+					4 * pixels, pixels, [&] {
+					x += moves[i].first; y += moves[i].second;
+					i = (i + 1) % moves.size();
+					auto const [vb2, vp2] = view_at();
+					auto const [dx, dy] = scroll_offset(vb, vp, vb2, vp2, n);
+					vb = vb2; vp = vp2;
+					if (!reuse || std::abs(dx) >= size.width || std::abs(dy) >= size.height) {
+						draw_area(rc, vb, vp, upscale);
+						return;
+					}
+
+					// shift the previous drawing and fill the exposed strips.
+					canvas.scroll(dx, dy);
+					auto const [sx, sy] = exposed_strips(dx, dy, size.width, size.height);
+					for (auto const& strip : { sx, sy }) {
+						if (strip.is_empty()) continue;
+						auto const [sub_vb, sub_vp] = sub_viewbox_viewport(strip, vb, vp, n);
+						if (sub_vb.is_empty()) canvas.fill_rect(strip, blank);
+						else draw_area(strip, sub_vb, sub_vp, upscale);
+					}
+				});
+			};
+
+			measure("full", false, false);
+			measure("scroll", false, true);
+			if (z <= 0) continue;
+			measure("full", true, false);
+			measure("scroll", true, true);
+		}
+	}
+}
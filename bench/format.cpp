@@ -0,0 +1,75 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+#include <cstdint>
+#include <cwchar>
+#include <vector>
+
+#include "harness.hpp"
+#include "text_format.hpp"
+#include "overlay.hpp"
+
+// the measurements of the texts of the tip, written by the formatters against swprintf(),
+// as on every mouse move with the sticky tip.
+
+using namespace bench;
+
+BENCHMARK(format_tip)
+{
+	// the pixels the tip points to, scattered over a 1080p frame.
+	constexpr int n = 1024, screen_w = 1919, screen_h = 1080;
+	struct Point { int x, y; uint32_t color; };
+	std::vector<Point> points(n);
+	test_util::Rng rng{ 16 };
+	for (auto& p : points) p = { static_cast<int>(rng() % screen_w), static_cast<int>(rng() % screen_h), rng() & 0xffffff };
+
+	wchar_t buf[64];
+	auto const run = [&](const char* what, const char* how, auto&& write) {
+		suite.measure(name({ "format", what, how }), 0, n, [&] {
+			int sum = 0;
+			for (auto const& p : points) sum += write(p), keep(buf);
+			keep(sum);
+		});
+	};
+	using namespace sigma_lib::format;
+	namespace ov = overlay;
+
+	run("hex6", "format", [&](const Point& p) { buf[0] = L'#'; return 1 + put_hex6(buf + 1, p.color, true); });
+	run("hex6", "swprintf", [&](const Point& p) { return std::swprintf(buf, std::size(buf), L"#%06X", p.color); });
+
+	auto const R = [](const Point& p) { return p.color & 0xff; };
+	auto const G = [](const Point& p) { return (p.color >> 8) & 0xff; };
+	auto const B = [](const Point& p) { return p.color >> 16; };
+	run("dec3x3", "format", [&](const Point& p) {
+		int len = put(buf, L"RGB(");
+		len += put_int(buf + len, R(p), 3); buf[len++] = L',';
+		len += put_int(buf + len, G(p), 3); buf[len++] = L',';
+		len += put_int(buf + len, B(p), 3); buf[len++] = L')';
+		return len;
+	});
+	run("dec3x3", "swprintf", [&](const Point& p) {
+		return std::swprintf(buf, std::size(buf), L"RGB(%3u,%3u,%3u)", R(p), G(p), B(p));
+	});
+
+	run("coord", "format", [&](const Point& p) { return ov::put_coord(buf, p.x, p.y, screen_w, screen_h, false); });
+	run("coord", "swprintf", [&](const Point& p) { return std::swprintf(buf, std::size(buf), L"X:%4d, Y:%4d", p.x, p.y); });
+
+	// the odd width makes halves on X.
+	run("coord_centered", "format", [&](const Point& p) { return ov::put_coord(buf, p.x, p.y, screen_w, screen_h, true); });
+	run("coord_centered", "swprintf", [&](const Point& p) {
+		return std::swprintf(buf, std::size(buf), L"X:%*.*f, Y:%*.*f",
+			6, 1, p.x - screen_w / 2.0, 4, 0, p.y - screen_h / 2.0);
+	});
+}
@@ -0,0 +1,55 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+#include <cstdint>
+
+#include "harness.hpp"
+#include "frame_diff.hpp"
+
+// the measurements of the difference view per frame of playback: keeping the pixels of the new frame,
+// and mapping the differences from the previous one into the false colors.
+// real time at 60 fps needs a frame within 16.7 ms.
+
+using namespace bench;
+
+BENCHMARK(frame_diff)
+{
+	for (auto const& size : suite.active_sizes({ "1080p", "4K", "8K" })) {
+		// two frames alternating, differing slightly as by compression.
+		auto const& a = suite.frame(Kind::noise, size);
+		Image b = a;
+		test_util::Rng rng{ 23 };
+		for (auto& p : b.pixels) p = static_cast<byte>(p + (rng() % 5) - 2);
+		auto const whole = Rect::of_size(size.width, size.height);
+		double const pixels = double(size.width) * size.height, bytes = 3 * pixels;
+
+		FrameDiff diff{};
+		int number = 0;
+		auto const next = [&] {
+			diff.next_frame(++number);
+			diff.capture((number % 2 != 0 ? b : a).view, whole, whole);
+		};
+		next(); next();
+
+		suite.measure(name({ "frame_diff/capture", size.name }), bytes, pixels, next);
+		suite.measure(name({ "frame_diff/render", size.name }), bytes, pixels, [&] {
+			keep(diff.render(whole).bits);
+		});
+		suite.measure(name({ "frame_diff/frame", size.name }), bytes, pixels, [&] {
+			next();
+			keep(diff.render(whole).bits);
+		});
+	}
+}
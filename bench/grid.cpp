@@ -0,0 +1,129 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+#include <cstdint>
+
+#include "harness.hpp"
+#include "canvas.hpp"
+#include "grid_raster.hpp"
+#include "grid_lines.hpp"
+#include "loupe_view.hpp"
+#include "strip_pool.hpp"
+
+// the measurements of the grid per frame: drawn line by line as through GDI, counting the calls,
+// against drawn at once by GridRaster, with its tiles hit or missed, and while playing.
+
+using namespace bench;
+
+// a canvas counting the drawing calls, each of which would be a call to GDI.
+class CountingCanvas final : public Canvas {
+	RasterCanvas& canvas;
+public:
+	size_t calls = 0;
+	CountingCanvas(RasterCanvas& canvas) : canvas{ canvas } {}
+
+	void fill_rect(const Rect& rc, uint32_t color) override { calls++; canvas.fill_rect(rc, color); }
+	void invert_rect(const Rect& rc) override { calls++; canvas.invert_rect(rc); }
+	void stretch_image(const Rect& dst_rc, const ImageView& src, const Rect& src_rc) override
+	{
+		calls++; canvas.stretch_image(dst_rc, src, src_rc);
+	}
+	void draw_image(int left, int top, const ImageView& src) override { calls++; canvas.draw_image(left, top, src); }
+};
+
+BENCHMARK(grid_per_frame)
+{
+	constexpr uint32_t colors[6] = { 0x222222, 0x444444, 0x666666, 0x999999, 0xbbbbbb, 0xdddddd };
+	for (auto const& size : suite.active_sizes({ "1080p", "4K" })) {
+		Image dst{ size.width, size.height, 4 };
+		RasterCanvas raster{ dst.view };
+		double const pixels = double(size.width) * size.height, bytes = 4 * pixels;
+
+		// x4, x5, x8 and x16, the least ones at which the grids show by default and beyond.
+		for (int z : { 8, 9, 12, 16 }) {
+			auto const level = scale_label(LoupeZoom::scale_ratio(z));
+			auto const [vb, vp] = viewbox_viewport({ z, 0 }, size.width / 2.0 + 0.5, size.height / 2.0 + 0.5,
+				size.width, size.height, size.width, size.height);
+			for (uint8_t thick : { 1, 2 }) {
+				auto const kind = thick == 1 ? "thin" : "thick";
+
+				CountingCanvas counting{ raster };
+				if (suite.measure(name({ "grid_frame/lines", kind, level, size.name }), bytes, pixels, [&] {
+					counting.calls = 0;
+					if (thick == 1) draw_grid_thin(counting, vb, vp);
+					else draw_grid_thick(counting, vb, vp, colors);
+				})) suite.count("calls", static_cast<double>(counting.calls));
+
+				// the view stays, so the classes are reused.
+				GridRaster grid{};
+				if (suite.measure(name({ "grid_frame/raster", kind, level, size.name }), bytes, pixels, [&] {
+					grid.draw(dst.view, vb, vp, thick, colors);
+				})) suite.count("calls", 1);
+			}
+		}
+	}
+}
+
+// the grid on a moving view, with the period of the grid taken from a tile or computed each time,
+// and the playback of frames with and without the grid.
+BENCHMARK(grid_tiles)
+{
+	constexpr uint32_t colors[6] = { 0x222222, 0x444444, 0x666666, 0x999999, 0xbbbbbb, 0xdddddd };
+	for (auto const& size : suite.active_sizes({ "1080p", "4K" })) {
+		auto const& frame = suite.frame(Kind::noise, size);
+		Image dst{ size.width, size.height, 4 };
+		RasterCanvas canvas{ dst.view };
+		double const pixels = double(size.width) * size.height, bytes = 4 * pixels;
+
+		for (int z : { 8, 12, 16 }) {
+			auto const level = scale_label(LoupeZoom::scale_ratio(z));
+			// views a pixel apart, so every draw recomputes the classes of the lines.
+			std::pair<Rect, Rect> views[2];
+			for (int i = 0; i < 2; i++) views[i] = viewbox_viewport({ z, 0 }, size.width / 2.0 + 0.5 + i, size.height / 2.0 + 0.5,
+				size.width, size.height, size.width, size.height);
+
+			for (uint8_t thick : { 1, 2 }) {
+				auto const kind = thick == 1 ? "thin" : "thick";
+				GridRaster grid{};
+				int i = 0;
+				auto const draw = [&] {
+					i ^= 1;
+					grid.draw(dst.view, views[i].first, views[i].second, thick, colors);
+				};
+
+				suite.measure(name({ "grid_tiles/hit", kind, level, size.name }), bytes, pixels, draw);
+				suite.measure(name({ "grid_tiles/cold", kind, level, size.name }), bytes, pixels, [&] {
+					// dropping the tiles makes the next draw render one anew.
+					grid.set_tile_capacity(0); grid.set_tile_capacity(GridRaster::max_tiles);
+					draw();
+				});
+				grid.set_tile_capacity(0);
+				suite.measure(name({ "grid_tiles/none", kind, level, size.name }), bytes, pixels, draw);
+				grid.set_tile_capacity(GridRaster::max_tiles);
+
+				// a new frame on the same view each time, as while playing.
+				auto const& [vb, vp] = views[0];
+				suite.measure(name({ "grid_tiles/playback", kind, level, size.name }), bytes, pixels, [&] {
+					canvas.stretch_image(vp, frame.view, vb);
+					grid.draw(dst.view, vb, vp, thick, colors);
+				});
+			}
+			auto const& [vb, vp] = views[0];
+			suite.measure(name({ "grid_tiles/playback", "off", level, size.name }), bytes, pixels, [&] {
+				canvas.stretch_image(vp, frame.view, vb);
+			});
+		}
+	}
+}
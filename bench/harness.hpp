@@ -0,0 +1,219 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <initializer_list>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <thread>
+
+#include "image_basics.hpp"
+#include "frames.hpp"
+
+////////////////////////////////
+// ベンチマークの枠組み．
+////////////////////////////////
+namespace bench
+{
+	using namespace sigma_lib::image;
+	using test_util::Image;
+	using test_frames::Kind;
+
+	// the sizes of the frames measured with.
+	struct Size {
+		const char* name;
+		int width, height;
+	};
+	constexpr Size sizes[] = {
+		{ "720p", 1280, 720 }, { "1080p", 1920, 1080 }, { "1440p", 2560, 1440 },
+		{ "4K", 3840, 2160 }, { "8K", 7680, 4320 },
+	};
+	constexpr Kind kinds[] = { Kind::gradient, Kind::noise, Kind::text };
+
+	// runs the measurements and collects the results.
+	class Suite {
+		struct Result {
+			std::string name;
+			uint64_t iterations;
+			double ns_per_iter, min_ns;
+			double bytes, pixels; // processed per iteration.
+			std::vector<std::pair<std::string, double>> counters{};
+		};
+		std::vector<Result> results{};
+
+		// the frames are generated on demand and kept while the same size is measured.
+		struct Cached { Kind kind; int width, height; Image image; };
+		std::vector<Cached> frames{};
+
+	public:
+		std::vector<std::string> filters{};
+		std::vector<std::string> size_names{};
+		double min_time = 0.2; // seconds per measurement.
+		bool smoke = false;	// one iteration each on the smallest size, for the test.
+
+		// whether the measurement of the name should run.
+		bool selected(const std::string& name) const
+		{
+			if (filters.empty()) return true;
+			for (auto& f : filters) if (name.find(f) != std::string::npos) return true;
+			return false;
+		}
+		// the sizes to measure with, out of `names` if specified.
+		std::vector<Size> active_sizes(std::initializer_list<std::string_view> names = {}) const
+		{
+			auto const in = [](auto const& list, std::string_view name) {
+				return std::find(list.begin(), list.end(), name) != list.end();
+			};
+			std::vector<Size> ret{};
+			for (auto const& s : sizes) {
+				if (smoke) {
+					// only the smallest of them.
+					if (names.size() > 0 ? !in(names, s.name) : &s != &sizes[0]) continue;
+					ret.push_back(s);
+					break;
+				}
+				if ((names.size() > 0 && !in(names, s.name)) ||
+					(!size_names.empty() && !in(size_names, s.name))) continue;
+				ret.push_back(s);
+			}
+			return ret;
+		}
+
+		// the synthetic frame of the kind and size, 24bpp.
+		const Image& frame(Kind kind, const Size& size)
+		{
+			for (auto& c : frames)
+				if (c.kind == kind && c.width == size.width && c.height == size.height) return c.image;
+			// drop the frames of other sizes to bound the memory.
+			std::erase_if(frames, [&](auto& c) { return c.width != size.width || c.height != size.height; });
+			frames.push_back({ kind, size.width, size.height, test_frames::make(kind, size.width, size.height) });
+			return frames.back().image;
+		}
+
+		// measures `body()`, which processes `bytes` and `pixels` per call for the throughput.
+		// returns false if not selected.
+		bool measure(const std::string& name, double bytes, double pixels, auto&& body)
+		{
+			if (!selected(name)) return false;
+			using clock = std::chrono::steady_clock;
+			auto const seconds = [](clock::duration d) { return std::chrono::duration<double>(d).count(); };
+
+			// warm up, then find the number of calls that take a tenth of the time.
+			auto t0 = clock::now();
+			body();
+			double once = seconds(clock::now() - t0);
+			uint64_t batch = 1;
+			if (!smoke) {
+				while (once * batch < min_time / 10 && batch < (uint64_t{ 1 } << 30)) batch *= 2;
+			}
+
+			std::vector<double> samples{};
+			double total = 0;
+			uint64_t iterations = 0;
+			do {
+				t0 = clock::now();
+				for (uint64_t i = 0; i < batch; i++) body();
+				double const t = seconds(clock::now() - t0);
+				samples.push_back(t / batch);
+				total += t; iterations += batch;
+			} while (!smoke && (total < min_time || samples.size() < 5) && samples.size() < 100);
+
+			std::sort(samples.begin(), samples.end());
+			results.push_back({ name, iterations, 1e9 * samples[samples.size() / 2], 1e9 * samples[0], bytes, pixels });
+			std::fprintf(stderr, "%-56s %12.1f us\n", name.c_str(), results.back().ns_per_iter / 1000);
+			return true;
+		}
+
+		// attaches a count per iteration to the measurement just made, such as the number of drawing calls.
+		void count(const std::string& key, double value)
+		{
+			if (results.empty()) return;
+			results.back().counters.emplace_back(key, value);
+			std::fprintf(stderr, "%-56s %12g\n", ("  " + key).c_str(), value);
+		}
+
+		// writes the results in JSON.
+		void write_json(FILE* fp) const
+		{
+			std::fprintf(fp, "{\n  \"context\": {\n");
+			std::fprintf(fp, "    \"hardware_threads\": %u,\n", std::thread::hardware_concurrency());
+			std::fprintf(fp, "    \"simd\": \"%s\",\n",
+			#if defined(SIGMA_LIB_IMAGE_AVX2)
+				"avx2"
+			#elif defined(SIGMA_LIB_IMAGE_SSE2)
+				"sse2"
+			#else
+				"none"
+			#endif
+			);
+			std::fprintf(fp, "    \"min_time_s\": %g\n  },\n  \"benchmarks\": [", min_time);
+			for (size_t i = 0; i < results.size(); i++) {
+				auto const& r = results[i];
+				double const s = r.ns_per_iter / 1e9;
+				std::fprintf(fp, "%s\n    { \"name\": \"%s\", \"iterations\": %llu, \"ns_per_iter\": %.1f, \"min_ns\": %.1f",
+					i == 0 ? "" : ",", r.name.c_str(), static_cast<unsigned long long>(r.iterations), r.ns_per_iter, r.min_ns);
+				if (r.bytes > 0) std::fprintf(fp, ", \"bytes_per_second\": %.0f", r.bytes / s);
+				if (r.pixels > 0) std::fprintf(fp, ", \"pixels_per_second\": %.0f", r.pixels / s);
+				for (auto const& [key, value] : r.counters) std::fprintf(fp, ", \"%s\": %g", key.c_str(), value);
+				std::fprintf(fp, " }");
+			}
+			std::fprintf(fp, "\n  ]\n}\n");
+		}
+	};
+
+	// the benchmarks registered by BENCHMARK().
+	using Func = void(*)(Suite&);
+	inline std::vector<Func>& registry() { static std::vector<Func> funcs{}; return funcs; }
+	struct Register { Register(Func f) { registry().push_back(f); } };
+
+#define BENCHMARK(name)	\
+	static void name(::bench::Suite&);	\
+	static ::bench::Register register_##name{ name };	\
+	static void name(::bench::Suite& suite)
+
+	// the name of the measurement from its parts joined by slashes.
+	inline std::string name(std::initializer_list<std::string> parts)
+	{
+		std::string ret{};
+		for (auto& p : parts) { if (!ret.empty()) ret += '/'; ret += p; }
+		return ret;
+	}
+
+	// the label of the scale, such as "x0.125" or "x4".
+	inline std::string scale_label(double scale)
+	{
+		char buf[32];
+		std::snprintf(buf, sizeof(buf), "x%g", scale);
+		return buf;
+	}
+
+	// keeps the compiler from dropping the computation of the value.
+	inline void keep(const auto& value)
+	{
+	#if defined(__GNUC__)
+		asm volatile("" : : "r,m"(value) : "memory");
+	#else
+		static const void* volatile sink; sink = &value;
+	#endif
+	}
+}
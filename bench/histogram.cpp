@@ -0,0 +1,63 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+#include <cstdint>
+#include <algorithm>
+#include <thread>
+#include <string>
+
+#include "harness.hpp"
+#include "histogram.hpp"
+#include "strip_pool.hpp"
+
+// the measurements of the histogram of the view: counting anew for a new frame,
+// and updating for moves of some pixels, whose cost follows the strips entering and leaving.
+
+using namespace bench;
+
+BENCHMARK(histogram_update)
+{
+	StripPool strips{};
+	strips.set_threads(std::clamp<int>(std::thread::hardware_concurrency(), 2, 16));
+	for (auto const& size : suite.active_sizes({ "1080p", "4K" })) {
+		auto const& frame = suite.frame(Kind::noise, size);
+		auto const whole = Rect::of_size(size.width, size.height);
+		// the view box of a window as large as the frame at x1, leaving room to move.
+		auto const view = whole.inflate(-size.width / 8, -size.height / 8);
+		double const pixels = double(view.width()) * view.height();
+
+		Histogram histogram{};
+		suite.measure(name({ "histogram/rebuild", size.name }), 3 * pixels, pixels, [&] {
+			histogram.invalidate(whole, whole);
+			histogram.update(frame.view, view);
+		});
+		suite.measure(name({ "histogram/rebuild_mt", size.name }), 3 * pixels, pixels, [&] {
+			histogram.invalidate(whole, whole);
+			histogram.update(frame.view, view, &strips);
+		});
+
+		// back and forth diagonally, so each move has a vertical and a horizontal strip of the width.
+		for (int step : { 1, 4, 16, 64 }) {
+			auto const moved = view.offset(step, step);
+			double const strip = 2.0 * step * (view.width() + view.height());
+			bool flip = false;
+			histogram.update(frame.view, view);
+			suite.measure(name({ "histogram/move", "d" + std::to_string(step), size.name }), 3 * strip, strip, [&] {
+				flip = !flip;
+				histogram.update(frame.view, flip ? moved : view);
+			});
+		}
+	}
+}
@@ -0,0 +1,61 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+#include <cstdint>
+#include <cstring>
+
+#include "harness.hpp"
+#include "image_ingest.hpp"
+
+// the measurements of taking in the frame: copying only the changed rows against the full copy.
+
+using namespace bench;
+
+BENCHMARK(ingest_diff_copy)
+{
+	for (auto const& size : suite.active_sizes({ "1080p", "4K", "8K" })) {
+		auto const& src = suite.frame(Kind::noise, size);
+		Image dst = src;
+		size_t const bytes = src.pixels.size();
+		double const pixels = double(size.width) * size.height;
+		auto const stride = src.view.stride;
+
+		suite.measure(name({ "ingest/memcpy", size.name }), double(bytes), pixels, [&] {
+			std::memcpy(dst.pixels.data(), src.pixels.data(), bytes);
+			keep(dst.pixels[0]);
+		});
+
+		// alternates the frame and the one with a byte changed in every `every` rows, so each call copies them.
+		auto const with_changes = [&](const char* label, int every) {
+			Image changed = src;
+			for (int y = 0; y < size.height; y += every) changed.at(size.width / 2, y)[1] ^= 0x80;
+			bool flip = false;
+			suite.measure(name({ "ingest/diff_copy", label, size.name }), double(bytes), pixels, [&] {
+				flip = !flip;
+				auto const dirty = ingest::diff_copy(dst.pixels.data(), (flip ? changed : src).pixels.data(),
+					size.width, size.height, stride, 3);
+				keep(dirty);
+			});
+		};
+		std::memcpy(dst.pixels.data(), src.pixels.data(), bytes);
+		suite.measure(name({ "ingest/diff_copy/identical", size.name }), double(bytes), pixels, [&] {
+			auto const dirty = ingest::diff_copy(dst.pixels.data(), src.pixels.data(), size.width, size.height, stride, 3);
+			keep(dirty);
+		});
+		with_changes("one_row", size.height);
+		with_changes("every_16th_row", 16);
+		with_changes("every_row", 1);
+	}
+}
@@ -0,0 +1,75 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+#include <cstdint>
+#include <cstdio>
+#include <cmath>
+#include <string>
+
+#include "harness.hpp"
+#include "lut3d.hpp"
+
+// the measurements of the 3D LUT: parsing .cube files of the common sizes,
+// and converting the view box of a frame, anew or for the strip a pan exposes.
+
+using namespace bench;
+
+// the text of a .cube file of `n` points, a grading with a slight curve and a tint.
+static std::string cube_text(int n)
+{
+	std::string ret = "TITLE \"bench\"\n# generated\nLUT_3D_SIZE " + std::to_string(n) + "\n";
+	char line[64];
+	for (int b = 0; b < n; b++) for (int g = 0; g < n; g++) for (int r = 0; r < n; r++) {
+		auto const f = [&](int i, double tint) { return std::pow(i / (n - 1.0), 0.9) * tint; };
+		std::snprintf(line, sizeof(line), "%.6f %.6f %.6f\n", f(r, 1.0), f(g, 0.95), 0.1 + f(b, 0.85));
+		ret += line;
+	}
+	return ret;
+}
+
+BENCHMARK(lut3d)
+{
+	for (int n : { 17, 33, 65 }) {
+		auto const text = cube_text(n);
+		auto const points = "n" + std::to_string(n);
+		Lut3D lut{};
+		suite.measure(name({ "lut3d/load", points }), static_cast<double>(text.size()), double(n) * n * n, [&] {
+			keep(lut.load(text.data(), text.size()));
+		});
+		// loaded here too, as the measurement above may be filtered out.
+		if (!lut.load(text.data(), text.size())) continue;
+
+		for (auto const& size : suite.active_sizes({ "1080p", "4K" })) {
+			auto const& frame = suite.frame(Kind::noise, size);
+			auto const whole = Rect::of_size(size.width, size.height);
+			double const pixels = double(size.width) * size.height;
+			suite.measure(name({ "lut3d/render", points, size.name }), 3 * pixels, pixels, [&] {
+				lut.invalidate(whole);
+				keep(lut.render(frame.view, whole).bits);
+			});
+
+			// panning by 16 pixels each way, back and forth; only the strips entering are converted.
+			auto const view = whole.inflate(-32, -32);
+			bool flip = false;
+			lut.invalidate(whole);
+			lut.render(frame.view, view);
+			double const strip = 16.0 * (view.width() + view.height());
+			suite.measure(name({ "lut3d/pan", points, size.name }), 3 * strip, strip, [&] {
+				flip = !flip;
+				keep(lut.render(frame.view, flip ? view.offset(16, 16) : view).bits);
+			});
+		}
+	}
+}
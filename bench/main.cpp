@@ -0,0 +1,55 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "harness.hpp"
+
+// runs the benchmarks and writes the results in JSON.
+// usage: color_loupe_bench [--filter SUBSTR]... [--size NAME]... [--min-time SEC] [--out FILE] [--smoke]
+//   --filter: runs only the measurements whose names contain any of the substrings.
+//   --size: measures only with the sizes of the names (720p, 1080p, 1440p, 4K, 8K).
+//   --smoke: runs each measurement once on the smallest size, to check they work.
+int main(int argc, char** argv)
+{
+	bench::Suite suite{};
+	const char* out = nullptr;
+	for (int i = 1; i < argc; i++) {
+		auto const arg = [&] { return i + 1 < argc ? argv[++i] : ""; };
+		if (std::strcmp(argv[i], "--filter") == 0) suite.filters.emplace_back(arg());
+		else if (std::strcmp(argv[i], "--size") == 0) suite.size_names.emplace_back(arg());
+		else if (std::strcmp(argv[i], "--min-time") == 0) suite.min_time = std::atof(arg());
+		else if (std::strcmp(argv[i], "--out") == 0) out = arg();
+		else if (std::strcmp(argv[i], "--smoke") == 0) suite.smoke = true;
+		else {
+			std::fprintf(stderr, "usage: %s [--filter SUBSTR]... [--size NAME]... [--min-time SEC] [--out FILE] [--smoke]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	for (auto f : bench::registry()) f(suite);
+
+	FILE* fp = out != nullptr ? std::fopen(out, "w") : stdout;
+	if (fp == nullptr) {
+		std::fprintf(stderr, "cannot open %s\n", out);
+		return 1;
+	}
+	suite.write_json(fp);
+	if (fp != stdout) std::fclose(fp);
+	return 0;
+}
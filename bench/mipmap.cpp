@@ -0,0 +1,84 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+#include <cstdint>
+#include <cmath>
+
+#include "harness.hpp"
+#include "mipmap.hpp"
+#include "canvas.hpp"
+#include "loupe_view.hpp"
+
+// the measurements of the zoomed-out views: building the pyramid, updating it for a changed tile,
+// and drawing from the reduced levels against stretching the whole source.
+
+using namespace bench;
+
+// draws the view from the level as draw_picture() does, extending the destination for the rounded source.
+static void draw_from_level(RasterCanvas& canvas, const MipPyramid& mipmap, const Rect& vb, const Rect& vp, int k)
+{
+	auto const& lv = mipmap.level(k);
+	auto const rc = MipPyramid::reduce(vb, k);
+	double const sx = static_cast<double>(vp.width()) / vb.width(), sy = static_cast<double>(vp.height()) / vb.height();
+	auto const X = [&](int x) { return vp.left + static_cast<int>(std::round(sx * ((x << k) - vb.left))); };
+	auto const Y = [&](int y) { return vp.top + static_cast<int>(std::round(sy * ((y << k) - vb.top))); };
+	canvas.stretch_image({ X(rc.left), Y(rc.top), X(rc.right), Y(rc.bottom) }, lv, rc);
+}
+
+BENCHMARK(mipmap)
+{
+	for (auto const& size : suite.active_sizes()) {
+		for (auto kind : kinds) {
+			auto const& frame = suite.frame(kind, size);
+			auto const whole = Rect::of_size(size.width, size.height);
+			auto const src = frame.view.bits;
+			double const pixels = double(size.width) * size.height, bytes = 3 * pixels;
+
+			MipPyramid mipmap{};
+			suite.measure(name({ "mipmap/build", test_frames::name_of(kind), size.name }), bytes, pixels, [&] {
+				mipmap.invalidate(Rect::empty(), Rect::empty());
+				mipmap.prepare(src, size.width, size.height, whole);
+			});
+
+			// a 64x64 area changed, as by a small edit.
+			int i = 0;
+			suite.measure(name({ "mipmap/update_tile", test_frames::name_of(kind), size.name }), 0, 64 * 64, [&] {
+				int const x = (97 * i) % (size.width - 64), y = (61 * i) % (size.height - 64);
+				i++;
+				mipmap.invalidate({ x, y, x + 64, y + 64 }, whole);
+				mipmap.prepare(src, size.width, size.height, whole);
+			});
+
+			// the window of the same size shows the whole frame reduced.
+			Image dst{ size.width, size.height, 4 };
+			RasterCanvas canvas{ dst.view };
+			mipmap.prepare(src, size.width, size.height, whole);
+			for (int z : { -4, -8, -12 }) {
+				auto const [vb, vp] = viewbox_viewport({ z, 0 }, size.width / 2.0, size.height / 2.0,
+					size.width, size.height, size.width, size.height);
+				auto const [n, d] = LoupeZoom::scale_ratio_Q(z);
+				int const k = MipPyramid::level_for(n, d);
+				auto const level = scale_label(LoupeZoom::scale_ratio(z));
+				double const out = double(vp.width()) * vp.height();
+				suite.measure(name({ "mipmap/draw_level", level, test_frames::name_of(kind), size.name }), 0, out, [&] {
+					draw_from_level(canvas, mipmap, vb, vp, k);
+				});
+				suite.measure(name({ "mipmap/draw_stretch", level, test_frames::name_of(kind), size.name }), 0, out, [&] {
+					canvas.stretch_image(vp, frame.view, vb);
+				});
+			}
+		}
+	}
+}
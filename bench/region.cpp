@@ -0,0 +1,94 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+#include <cstdint>
+#include <cmath>
+#include <vector>
+#include <string>
+
+#include "harness.hpp"
+#include "region_stats.hpp"
+
+// the measurements of the statistics of regions: building the summed-area tables,
+// and the queries answered from them against scanning the pixels.
+
+using namespace bench;
+
+// the statistics of the region by scanning the pixels, as without the tables.
+static RegionStats::Stats scan_stats(const ImageView& src, const Rect& rc)
+{
+	RegionStats::Stats ret{ .count = rc.width() * rc.height() };
+	uint64_t sum[3]{}, sq[3]{};
+	byte lo[3]{ 255, 255, 255 }, hi[3]{ 0, 0, 0 };
+	for (int y = rc.top; y < rc.bottom; y++) {
+		const byte* s = src.row(y) + 3 * rc.left;
+		for (int x = rc.left; x < rc.right; x++, s += 3) {
+			for (int c = 0; c < 3; c++) {
+				sum[c] += s[c]; sq[c] += s[c] * s[c];
+				lo[c] = std::min(lo[c], s[c]); hi[c] = std::max(hi[c], s[c]);
+			}
+		}
+	}
+	double const n = ret.count;
+	for (int c = 0; c < 3; c++) {
+		double const m = sum[c] / n;
+		ret.mean[c] = static_cast<byte>(std::lround(m));
+		ret.deviation10[c] = static_cast<uint16_t>(std::lround(10 * std::sqrt(std::max(sq[c] / n - m * m, 0.0))));
+		ret.min[c] = lo[c]; ret.max[c] = hi[c];
+	}
+	return ret;
+}
+
+BENCHMARK(region_stats)
+{
+	for (auto const& size : suite.active_sizes({ "1080p", "4K" })) {
+		auto const& frame = suite.frame(Kind::noise, size);
+		auto const whole = Rect::of_size(size.width, size.height);
+		double const pixels = double(size.width) * size.height;
+
+		// the tables around a pixel as the tip queries first, and over the whole frame,
+		// which scans the pixels for the extremes as well.
+		RegionStats stats{};
+		auto const center = RegionStats::neighborhood(size.width / 2, size.height / 2, 1);
+		auto const around = center.inflate(RegionStats::margin, RegionStats::margin);
+		suite.measure(name({ "region_stats/build/around", size.name }), 3.0 * around.width() * around.height(),
+			double(around.width()) * around.height(), [&] {
+			stats.invalidate(whole, whole);
+			keep(stats.query(frame.view, center));
+		});
+		suite.measure(name({ "region_stats/build/frame", size.name }), 3 * pixels, pixels, [&] {
+			stats.invalidate(whole, whole);
+			keep(stats.query(frame.view, whole));
+		});
+
+		// the queries around scattered pixels, with the tables built.
+		constexpr int n = 256;
+		std::vector<std::pair<int, int>> points(n);
+		test_util::Rng rng{ 21 };
+		for (auto& [x, y] : points) x = rng() % size.width, y = rng() % size.height;
+		for (int k : { 3, 9, 33, 129 }) {
+			auto const kk = "k" + std::to_string(k);
+			// covers all the points once, then every query hits.
+			stats.invalidate(whole, whole);
+			stats.query(frame.view, whole);
+			suite.measure(name({ "region_stats/query", kk, size.name }), 0, n, [&] {
+				for (auto [x, y] : points) keep(stats.query(frame.view, RegionStats::neighborhood(x, y, k)));
+			});
+			suite.measure(name({ "region_stats/scan", kk, size.name }), 0, n, [&] {
+				for (auto [x, y] : points) keep(scan_stats(frame.view, RegionStats::neighborhood(x, y, k) & whole));
+			});
+		}
+	}
+}
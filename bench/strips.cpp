@@ -0,0 +1,71 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+#include <cstdint>
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include <string>
+
+#include "harness.hpp"
+#include "upscale.hpp"
+#include "grid_raster.hpp"
+#include "loupe_view.hpp"
+#include "strip_pool.hpp"
+
+// the measurements of the strip-parallel drawings of a frame on large windows,
+// with the number of threads from 1 to those of the hardware.
+
+using namespace bench;
+
+// 1, 2, 4, ... and the number of the hardware threads, at least 2 so the parallel path is taken.
+static std::vector<int> thread_counts()
+{
+	int const n = std::max<int>(std::thread::hardware_concurrency(), 2);
+	std::vector<int> ret{};
+	for (int t = 1; t < n; t *= 2) ret.push_back(t);
+	ret.push_back(n);
+	return ret;
+}
+
+BENCHMARK(strip_scaling)
+{
+	constexpr uint32_t colors[6] = { 0x222222, 0x444444, 0x666666, 0x999999, 0xbbbbbb, 0xdddddd };
+	StripPool strips{};
+	for (auto const& size : suite.active_sizes({ "4K", "8K" })) {
+		auto const& frame = suite.frame(Kind::noise, size);
+		Image dst{ size.width, size.height, 4 };
+		Upscaler upscaler{};
+		GridRaster grid{};
+		auto const rc = Rect::of_size(size.width, size.height);
+		double const pixels = double(size.width) * size.height, bytes = 4 * pixels;
+
+		for (int threads : thread_counts()) {
+			strips.set_threads(threads);
+			auto const t = "t" + std::to_string(threads);
+			for (int z : { 6, 8, 16 }) {
+				auto const [vb, vp] = viewbox_viewport({ z, 0 }, size.width / 2.0 + 0.5, size.height / 2.0 + 0.5,
+					size.width, size.height, size.width, size.height);
+				auto const level = scale_label(LoupeZoom::scale_ratio(z));
+				suite.measure(name({ "strips/upscaler", level, t, size.name }), bytes, pixels, [&] {
+					keep(upscaler.render(frame.view, vb, vp, rc, &strips).bits);
+				});
+				suite.measure(name({ "strips/grid", level, t, size.name }), bytes, pixels, [&] {
+					grid.draw(dst.view, vb, vp, 2, colors, &strips);
+				});
+			}
+		}
+	}
+}
@@ -0,0 +1,64 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+#include <cstdint>
+#include <algorithm>
+#include <thread>
+
+#include "harness.hpp"
+#include "upscale.hpp"
+#include "canvas.hpp"
+#include "loupe_view.hpp"
+#include "strip_pool.hpp"
+
+// the measurements of the magnified views on large windows,
+// the software upscaler against stretching as StretchDIBits() does, up to x64.
+
+using namespace bench;
+
+BENCHMARK(upscale_levels)
+{
+	StripPool strips{};
+	strips.set_threads(std::clamp<int>(std::thread::hardware_concurrency(), 2, 16));
+	for (auto const& size : suite.active_sizes({ "1080p", "4K", "8K" })) {
+		auto const& frame = suite.frame(Kind::noise, size);
+		Image dst{ size.width, size.height, 4 };
+		RasterCanvas canvas{ dst.view };
+		Upscaler upscaler{};
+		auto const rc = Rect::of_size(size.width, size.height);
+		double const pixels = double(size.width) * size.height, bytes = 4 * pixels;
+
+		for (int z : { 1, 2, 3, 4, 8, 12, 16, 18, 20, 22, 24 }) {
+			// a position off the pixel grid, as while dragging.
+			auto const [vb, vp] = viewbox_viewport({ z, 0 }, size.width / 2.0 + 0.3, size.height / 2.0 + 0.7,
+				size.width, size.height, size.width, size.height);
+			auto const level = scale_label(LoupeZoom::scale_ratio(z));
+			suite.measure(name({ "upscale/stretch", level, size.name }), bytes, pixels, [&] {
+				canvas.stretch_image(vp, frame.view, vb);
+			});
+			suite.measure(name({ "upscale/upscaler", level, size.name }), bytes, pixels, [&] {
+				auto const& out = upscaler.render(frame.view, vb, vp, rc);
+				canvas.draw_image(std::max(vp.left, 0), std::max(vp.top, 0), out);
+			});
+			suite.measure(name({ "upscale/upscaler_only", level, size.name }), 0, pixels, [&] {
+				keep(upscaler.render(frame.view, vb, vp, rc).bits);
+			});
+			suite.measure(name({ "upscale/upscaler_mt", level, size.name }), bytes, pixels, [&] {
+				auto const& out = upscaler.render(frame.view, vb, vp, rc, &strips);
+				canvas.draw_image(std::max(vp.left, 0), std::max(vp.top, 0), out);
+			});
+		}
+	}
+}
@@ -0,0 +1,215 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "harness.hpp"
+#include "image_buffer.hpp"
+#include "loupe_view.hpp"
+#include "canvas.hpp"
+#include "upscale.hpp"
+#include "grid_raster.hpp"
+#include "chrome_sprite.hpp"
+#include "glyph_atlas.hpp"
+#include "overlay.hpp"
+#include "strip_pool.hpp"
+
+// the measurements of a frame shown in the loupe: taking in the frame, looking up pixels,
+// computing the view, scaling the picture, and drawing the grid and the overlays.
+
+using namespace bench;
+
+// the number of threads for the parallel variants.
+static int parallel_threads() { return std::clamp<int>(std::thread::hardware_concurrency(), 2, 16); }
+
+// taking in a frame: all rows changed, or none changed, which only compares.
+BENCHMARK(image_buffer_update)
+{
+	for (auto const& size : suite.active_sizes()) {
+		for (auto kind : kinds) {
+			auto const& a = suite.frame(kind, size);
+			Image b = a;
+			for (auto& p : b.pixels) p ^= 1;
+			double const bytes = static_cast<double>(a.pixels.size()), pixels = double(size.width) * size.height;
+
+			ImageBuffer image{};
+			image.update(size.width, size.height, a.view.bits);
+			bool flip = false;
+			suite.measure(name({ "image_buffer/update/changed", test_frames::name_of(kind), size.name }), bytes, pixels, [&] {
+				flip = !flip;
+				image.update(size.width, size.height, (flip ? b : a).view.bits);
+			});
+			suite.measure(name({ "image_buffer/update/unchanged", test_frames::name_of(kind), size.name }), bytes, pixels, [&] {
+				image.update(size.width, size.height, a.view.bits);
+			});
+		}
+	}
+}
+
+// looking up pixels at scattered positions, as the tip and the color code do.
+BENCHMARK(image_buffer_color_at)
+{
+	for (auto const& size : suite.active_sizes()) {
+		auto const& frame = suite.frame(Kind::noise, size);
+		ImageBuffer image{};
+		image.update(size.width, size.height, frame.view.bits);
+
+		constexpr int n = 4096;
+		std::vector<std::pair<int, int>> points(n);
+		test_util::Rng rng{ 77 };
+		for (auto& [x, y] : points) x = rng() % size.width, y = rng() % size.height;
+		suite.measure(name({ "image_buffer/color_at", size.name }), 0, n, [&] {
+			uint32_t sum = 0;
+			for (auto [x, y] : points) sum += image.color_at(x, y);
+			keep(sum);
+		});
+	}
+}
+
+// the view box and port at every zoom level, with the window of the size over the frame of the size.
+BENCHMARK(view_viewbox_viewport)
+{
+	for (auto const& size : suite.active_sizes()) {
+		// all the 42 levels per call.
+		suite.measure(name({ "view/viewbox_viewport", size.name }), 0, 0, [&] {
+			for (int z = LoupeZoom::zoom_level_min; z <= LoupeZoom::zoom_level_max; z++) {
+				auto const vv = viewbox_viewport({ z, 0 }, size.width / 2.0 + 0.25, size.height / 2.0 - 0.75,
+					size.width, size.height, size.width, size.height);
+				keep(vv);
+			}
+		});
+	}
+}
+
+// scaling the frame into a window of the same size at some zoom levels.
+BENCHMARK(scale_picture)
+{
+	StripPool strips{};
+	strips.set_threads(parallel_threads());
+	for (auto const& size : suite.active_sizes()) {
+		for (auto kind : kinds) {
+			auto const& frame = suite.frame(kind, size);
+			Image dst{ size.width, size.height, 4 };
+			RasterCanvas canvas{ dst.view };
+			Upscaler upscaler{};
+			double const pixels = double(size.width) * size.height, bytes = 4 * pixels;
+			auto const rc = Rect::of_size(size.width, size.height);
+
+			for (int z : { -4, 2, 8, 16 }) {
+				auto const [vb, vp] = viewbox_viewport({ z, 0 }, size.width / 2.0, size.height / 2.0,
+					size.width, size.height, size.width, size.height);
+				auto const level = scale_label(LoupeZoom::scale_ratio(z));
+				suite.measure(name({ "scale/stretch", level, test_frames::name_of(kind), size.name }), bytes, pixels, [&] {
+					canvas.stretch_image(vp, frame.view, vb);
+				});
+				if (z <= 0) continue;
+				suite.measure(name({ "scale/upscaler", level, test_frames::name_of(kind), size.name }), bytes, pixels, [&] {
+					auto const& out = upscaler.render(frame.view, vb, vp, rc);
+					canvas.draw_image(std::max(vp.left, 0), std::max(vp.top, 0), out);
+				});
+				suite.measure(name({ "scale/upscaler_mt", level, test_frames::name_of(kind), size.name }), bytes, pixels, [&] {
+					auto const& out = upscaler.render(frame.view, vb, vp, rc, &strips);
+					canvas.draw_image(std::max(vp.left, 0), std::max(vp.top, 0), out);
+				});
+			}
+		}
+	}
+}
+
+// drawing the grid over the window at a zoom level showing it.
+BENCHMARK(draw_grid)
+{
+	constexpr uint32_t colors[6] = { 0x222222, 0x444444, 0x666666, 0x999999, 0xbbbbbb, 0xdddddd };
+	StripPool strips{};
+	strips.set_threads(parallel_threads());
+	for (auto const& size : suite.active_sizes()) {
+		auto const& frame = suite.frame(Kind::text, size);
+		Image dst{ size.width, size.height, 4 };
+		double const pixels = double(size.width) * size.height, bytes = 4 * pixels;
+		auto const [vb, vp] = viewbox_viewport({ 12, 0 }, size.width / 2.0 + 0.5, size.height / 2.0 + 0.5,
+			size.width, size.height, size.width, size.height);
+
+		for (uint8_t thick : { 1, 2 }) {
+			auto const kind = thick == 1 ? "thin" : "thick";
+			GridRaster grid{};
+			suite.measure(name({ "grid/draw", kind, size.name }), bytes, pixels, [&] {
+				grid.draw(dst.view, vb, vp, thick, colors);
+			});
+			suite.measure(name({ "grid/draw_mt", kind, size.name }), bytes, pixels, [&] {
+				grid.draw(dst.view, vb, vp, thick, colors, &strips);
+			});
+			suite.measure(name({ "grid/draw_adaptive", kind, size.name }), bytes, pixels, [&] {
+				grid.draw_adaptive(dst.view, frame.view, vb, vp, thick, colors);
+			});
+		}
+	}
+}
+
+// drawing the tip and the toast with the sprites and the glyphs, as when the mouse moves.
+BENCHMARK(draw_overlays)
+{
+	GlyphAtlas glyphs{};
+	{
+		GlyphAtlas::Glyph layout[GlyphAtlas::num_glyphs];
+		for (auto& g : layout) g = { .x = 0, .left = -1, .width = 9, .advance = 8 };
+		int const width = GlyphAtlas::layout(layout);
+		Image strip{ width, 16 };
+		for (int i = 0; i < GlyphAtlas::num_glyphs; i++) {
+			wchar_t const str[] = { static_cast<wchar_t>(GlyphAtlas::first_char + i), L'\0' };
+			test_frames::draw_dots(strip, layout[i].x + 1, 2, 1, str, 0xffffff);
+		}
+		glyphs.build(layout, 16, strip.view);
+	}
+	ChromeSprites chrome{};
+
+	for (auto const& size : suite.active_sizes()) {
+		Image dst{ size.width, size.height, 4 };
+		RasterCanvas canvas{ dst.view };
+		test_util::Rng rng{ 5 };
+		bool prefer_above = false;
+		suite.measure(name({ "overlay/tip", size.name }), 0, 0, [&] {
+			int const x = rng() % size.width, y = rng() % size.height;
+			Rect const box{ x, y, x + 8, y + 8 };
+			overlay::draw_pixel_box(canvas, box.inflate(4, 4), 0x336699, 0xffffff);
+
+			wchar_t str[64];
+			int len = 0;
+			len += sigma_lib::format::put(str + len, L"#336699\n");
+			len += overlay::put_coord(str + len, x, y, size.width, size.height, false);
+			auto const [w, h] = glyphs.measure(str, len);
+			auto const layout = overlay::place_tip(box, w, h, size.width, size.height, 10, { 4, 4, 10, 3 }, prefer_above);
+			chrome.draw(dst.view, layout.frame.left, layout.frame.top, {
+				.width = layout.frame.width(), .height = layout.frame.height(), .corner = 8, .thick = 1,
+				.back_top = 0xffffff, .back_bottom = 0xf7ece4, .chrome = 0x767676 });
+			glyphs.draw(dst.view, layout.text.left, layout.text.top, layout.text.width(), true, str, len, 0x3f3d3b);
+		});
+
+		int placement = 0;
+		suite.measure(name({ "overlay/toast", size.name }), 0, 0, [&] {
+			constexpr wchar_t message[] = L"Zoom x4.00";
+			constexpr int len = static_cast<int>(std::size(message)) - 1;
+			auto const [w, h] = glyphs.measure(message, len);
+			auto const layout = overlay::place_toast(w, h, size.width, size.height,
+				placement % 3 - 1, placement / 3 - 1, { 4, 4, 6, 4 });
+			placement = (placement + 1) % 9;
+			chrome.draw(dst.view, layout.frame.left, layout.frame.top, {
+				.width = layout.frame.width(), .height = layout.frame.height(), .corner = 8, .thick = 1,
+				.back_top = 0xffffff, .back_bottom = 0xf7ece4, .chrome = 0x767676 });
+			glyphs.draw(dst.view, layout.text.left, layout.text.top, layout.text.width(), false, message, len, 0x3f3d3b);
+		});
+	}
+}
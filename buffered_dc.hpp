@@ -18,8 +18,13 @@ THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR I
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
 
+#include "surface.hpp"
+#include "canvas.hpp"
+
 namespace sigma_lib::W32::GDI
 {
+	class DIBSurface;
+
 	// ダブルバファリング用の HDC ラッパー．
 	class BufferedDC {
 		HWND const owner;
@@ -28,6 +33,15 @@ namespace sigma_lib::W32::GDI
 		HDC back_dc;
 		HGDIOBJ bmp;
 
+		// whether back_dc was created by this instance.
+		bool owns_back = false;
+
+		// the areas to copy to the front, or the entire client if `partial` is false.
+		constexpr static int max_damages = 4;
+		RECT damages[max_damages]{};
+		int num_damages = 0;
+		bool partial = false;
+
 	public:
 		BufferedDC(HWND hwnd, int width, int height, bool use_back = true)
 			: owner{ hwnd }, front_dc{ ::GetDC(hwnd) }, rect{ 0, 0, width, height }
@@ -35,6 +49,7 @@ namespace sigma_lib::W32::GDI
 			if (use_back) {
 				back_dc = ::CreateCompatibleDC(front_dc);
 				bmp = ::SelectObject(back_dc, ::CreateCompatibleBitmap(front_dc, width, height));
+				owns_back = true;
 			}
 			else {
 				back_dc = nullptr;
@@ -44,12 +59,27 @@ namespace sigma_lib::W32::GDI
 		BufferedDC(HWND hwnd, SIZE const& sz, bool use_back) : BufferedDC(hwnd, sz.cx, sz.cy, use_back) {}
 		BufferedDC(HWND hwnd, bool use_back = true) : BufferedDC{ hwnd, client_size(hwnd), use_back } {}
 
+		// uses the persistent `back` surface instead of creating a bitmap every time.
+		// falls back to the direct drawing if the surface couldn't be allocated.
+		BufferedDC(HWND hwnd, DIBSurface& back, int width, int height, bool use_back = true);
+		BufferedDC(HWND hwnd, DIBSurface& back, SIZE const& sz, bool use_back)
+			: BufferedDC(hwnd, back, sz.cx, sz.cy, use_back) {}
+
 		~BufferedDC()
 		{
 			if (is_wrapped()) {
-				::BitBlt(front_dc, 0, 0, rect.right, rect.bottom, back_dc, 0, 0, SRCCOPY);
-				::DeleteObject(::SelectObject(back_dc, bmp));
-				::DeleteDC(back_dc);
+				if (partial) {
+					for (int i = 0; i < num_damages; i++) {
+						auto const& rc = damages[i];
+						::BitBlt(front_dc, rc.left, rc.top, rc.right - rc.left, rc.bottom - rc.top,
+							back_dc, rc.left, rc.top, SRCCOPY);
+					}
+				}
+				else ::BitBlt(front_dc, 0, 0, rect.right, rect.bottom, back_dc, 0, 0, SRCCOPY);
+				if (owns_back) {
+					::DeleteObject(::SelectObject(back_dc, bmp));
+					::DeleteDC(back_dc);
+				}
 			}
 
 			::ReleaseDC(owner, front_dc);
@@ -59,6 +89,17 @@ namespace sigma_lib::W32::GDI
 
 		HWND hwnd() const { return owner; }
 		constexpr HDC hdc() const { return is_wrapped() ? back_dc : front_dc; }
+
+		// limits copying to the front to the rects added by this function,
+		// for when the front already holds the rest.
+		void add_damage(const RECT& rc)
+		{
+			partial = true;
+			RECT r;
+			if (!::IntersectRect(&r, &rc, &rect)) return;
+			if (num_damages < max_damages) damages[num_damages++] = r;
+			else ::UnionRect(&damages[max_damages - 1], &damages[max_damages - 1], &r);
+		}
 		// width of the client.
 		constexpr int wd() const { return rect.right; }
 		// height of the client.
@@ -104,4 +145,114 @@ namespace sigma_lib::W32::GDI
 			::DeleteDC(back_dc);
 		}
 	};
-}
\ No newline at end of file
+
+	// DIB セクションによる描画先．
+	// 32bpp is for presenting to the screen, which takes no conversion of the pixel format,
+	// while 24bpp is for the images the software drawings read from.
+	class DIBSurface final : public image::Surface {
+		HDC back_dc = nullptr;
+		HGDIOBJ bmp = nullptr;
+		int depth = 3; // bytes per pixel.
+
+		bool allocate(int width, int height) override
+		{
+			deallocate();
+
+			BITMAPINFO const bi{
+				.bmiHeader = {
+					.biSize = sizeof(bi.bmiHeader),
+					.biWidth = width,
+					.biHeight = height,
+					.biPlanes = 1,
+					.biBitCount = static_cast<WORD>(8 * depth),
+					.biCompression = BI_RGB,
+				},
+			};
+			void* bits = nullptr;
+			auto dib = ::CreateDIBSection(nullptr, &bi, DIB_RGB_COLORS, &bits, nullptr, 0);
+			if (dib == nullptr) return false;
+
+			back_dc = ::CreateCompatibleDC(nullptr);
+			bmp = ::SelectObject(back_dc, dib);
+			pixels = { static_cast<image::byte*>(bits), width, height, image::ImageView::stride_of(width, depth), depth };
+			return true;
+		}
+		void deallocate() override
+		{
+			if (back_dc == nullptr) return;
+			::DeleteObject(::SelectObject(back_dc, bmp));
+			::DeleteDC(back_dc);
+			back_dc = nullptr; bmp = nullptr;
+		}
+
+	public:
+		constexpr DIBSurface() = default;
+		// `bytes_per_pixel` is either 3 or 4.
+		constexpr explicit DIBSurface(int bytes_per_pixel) : depth{ bytes_per_pixel } {}
+		~DIBSurface() override { release(); }
+
+		// call ::GdiFlush() before touching view().bits after drawing by GDI.
+		constexpr HDC hdc() const { return back_dc; }
+	};
+
+	// HDC に描画する Canvas.
+	class GdiCanvas final : public image::Canvas {
+		HDC const dc;
+
+	public:
+		constexpr GdiCanvas(HDC hdc) : dc{ hdc } {}
+		constexpr HDC hdc() const { return dc; }
+
+		void fill_rect(const image::Rect& rc, uint32_t color) override
+		{
+			::SetDCBrushColor(dc, color);
+			::FillRect(dc, reinterpret_cast<const RECT*>(&rc), static_cast<HBRUSH>(::GetStockObject(DC_BRUSH)));
+		}
+		void invert_rect(const image::Rect& rc) override
+		{
+			::PatBlt(dc, rc.left, rc.top, rc.width(), rc.height(), DSTINVERT);
+		}
+		void stretch_image(const image::Rect& dst_rc, const image::ImageView& src, const image::Rect& src_rc) override
+		{
+			BITMAPINFO const bi{
+				.bmiHeader = {
+					.biSize = sizeof(bi.bmiHeader),
+					.biWidth = src.width,
+					.biHeight = src.height,
+					.biPlanes = 1,
+					.biBitCount = static_cast<WORD>(8 * src.depth),
+					.biCompression = BI_RGB,
+				},
+			};
+			::SetStretchBltMode(dc, STRETCH_DELETESCANS);
+			::StretchDIBits(dc, dst_rc.left, dst_rc.top, dst_rc.width(), dst_rc.height(),
+				src_rc.left, src.height - src_rc.bottom, src_rc.width(), src_rc.height(),
+				src.bits, &bi, DIB_RGB_COLORS, SRCCOPY);
+		}
+		void draw_image(int left, int top, const image::ImageView& src) override
+		{
+			BITMAPINFO const bi{
+				.bmiHeader = {
+					.biSize = sizeof(bi.bmiHeader),
+					.biWidth = src.width,
+					.biHeight = src.height,
+					.biPlanes = 1,
+					.biBitCount = static_cast<WORD>(8 * src.depth),
+					.biCompression = BI_RGB,
+				},
+			};
+			::SetDIBitsToDevice(dc, left, top, src.width, src.height, 0, 0, 0, src.height,
+				src.bits, &bi, DIB_RGB_COLORS);
+		}
+	};
+
+	inline BufferedDC::BufferedDC(HWND hwnd, DIBSurface& back, int width, int height, bool use_back)
+		: owner{ hwnd }, front_dc{ ::GetDC(hwnd) }, rect{ 0, 0, width, height }
+		, back_dc{ nullptr }, bmp{ nullptr }
+	{
+		if (use_back) {
+			back.resize(width, height);
+			back_dc = back.hdc();
+		}
+	}
+}
@@ -0,0 +1,163 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+#include "image_basics.hpp"
+#include "frame_alloc.hpp"
+
+////////////////////////////////
+// 描画操作の抽象化．
+////////////////////////////////
+namespace sigma_lib::image
+{
+	// the drawing operations the loupe uses for the picture, the grid and the pixel box of the tip,
+	// so they can run on a device context or on a memory image alike.
+	// colors are of COLORREF (0x00BBGGRR).
+	class Canvas {
+	public:
+		constexpr virtual ~Canvas() = default;
+
+		// fills the rect with the color.
+		virtual void fill_rect(const Rect& rc, uint32_t color) = 0;
+		// inverts the pixels in the rect.
+		virtual void invert_rect(const Rect& rc) = 0;
+		// draws the `src_rc` area of `src` scaled to `dst_rc` by nearest neighbor.
+		// GdiCanvas leaves it to StretchDIBits() with STRETCH_DELETESCANS, whose pixels at
+		// non-integer ratios aren't pinned down; RasterCanvas maps source pixels to the spans
+		// the grid lines are drawn at, the same as Upscaler, as tests/raster_canvas.cpp checks.
+		virtual void stretch_image(const Rect& dst_rc, const ImageView& src, const Rect& src_rc) = 0;
+		// draws the entire `src` as is, with its top-left corner at (`left`, `top`).
+		virtual void draw_image(int left, int top, const ImageView& src) = 0;
+	};
+
+	// a canvas on the pixels of an image, for drawing without any device.
+	// it draws onto the pixels attached, such as those of a DIB section, or onto its own 32bpp pixels.
+	class RasterCanvas final : public Canvas {
+		FrameAllocator pool{};
+		ImageView dst{};
+
+		constexpr Rect bounds() const { return Rect::of_size(dst.width, dst.height); }
+		static void put(byte* p, uint32_t colorref) {
+			p[0] = static_cast<byte>(colorref >> 16);
+			p[1] = static_cast<byte>(colorref >> 8);
+			p[2] = static_cast<byte>(colorref);
+		}
+
+	public:
+		constexpr RasterCanvas() = default;
+		// draws onto the `pixels` owned by someone else, of 24bpp or 32bpp.
+		constexpr explicit RasterCanvas(const ImageView& pixels) : dst{ pixels } {}
+		RasterCanvas(const RasterCanvas&) = delete;
+
+		// makes sure of its own pixels of the size. the content is undefined when the size changed.
+		bool resize(int width, int height)
+		{
+			if (dst.bits != nullptr && width == dst.width && height == dst.height && dst.depth == 4 &&
+				dst.bits == pool.data()) return true;
+			auto const stride = ImageView::stride_of(width, 4);
+			auto const bits = width > 0 && height > 0 ?
+				static_cast<byte*>(pool.allocate(stride * height)) : nullptr;
+			if (bits == nullptr) {
+				dst = {};
+				return false;
+			}
+			dst = { bits, width, height, stride, 4 };
+			return true;
+		}
+		void release() { pool.release(); dst = {}; }
+
+		constexpr const ImageView& view() const { return dst; }
+		constexpr int width() const { return dst.width; }
+		constexpr int height() const { return dst.height; }
+
+		// moves the whole pixels by (`dx`, `dy`), as BitBlt() onto itself does.
+		// the pixels exposed are left as they were.
+		void scroll(int dx, int dy)
+		{
+			auto const r = bounds() & bounds().offset(dx, dy);
+			if (r.is_empty() || (dx == 0 && dy == 0)) return;
+			size_t const d = dst.depth, len = d * r.width();
+			auto const move = [&](int y) { std::memmove(dst.row(y) + d * r.left, dst.row(y - dy) + d * (r.left - dx), len); };
+			// rows in the order not to overwrite those yet to move.
+			if (dy > 0) for (int y = r.bottom; --y >= r.top;) move(y);
+			else for (int y = r.top; y < r.bottom; y++) move(y);
+		}
+
+		void fill_rect(const Rect& rc, uint32_t color) override
+		{
+			auto const r = rc & bounds();
+			if (r.is_empty()) return;
+			int const d = dst.depth;
+			for (int y = r.top; y < r.bottom; y++) {
+				byte* const row = dst.row(y);
+				for (int x = r.left; x < r.right; x++) put(row + d * x, color);
+			}
+		}
+
+		void invert_rect(const Rect& rc) override
+		{
+			auto const r = rc & bounds();
+			if (r.is_empty()) return;
+			int const d = dst.depth;
+			for (int y = r.top; y < r.bottom; y++) {
+				for (byte* p = dst.row(y) + d * r.left, *e = dst.row(y) + d * r.right; p < e; p += d)
+					p[0] ^= 0xff, p[1] ^= 0xff, p[2] ^= 0xff;
+			}
+		}
+
+		void stretch_image(const Rect& dst_rc, const ImageView& src, const Rect& src_rc) override
+		{
+			int const W = dst_rc.width(), H = dst_rc.height(), w = src_rc.width(), h = src_rc.height();
+			auto const r = dst_rc & bounds();
+			if (r.is_empty() || w <= 0 || h <= 0) return;
+
+			// destination `X` shows the last source `i` with `i * W / w <= X`,
+			// which agrees with the spans the grid lines are drawn at.
+			auto const src_of = [](int X, int n, int N) {
+				return static_cast<int>((static_cast<int64_t>(X + 1) * n - 1) / N);
+			};
+			int const d = dst.depth;
+			for (int y = r.top; y < r.bottom; y++) {
+				const byte* const s = src.row(src_rc.top + src_of(y - dst_rc.top, h, H)) + 3 * src_rc.left;
+				byte* const row = dst.row(y);
+				for (int x = r.left; x < r.right; x++) {
+					const byte* const p = s + 3 * src_of(x - dst_rc.left, w, W);
+					byte* const q = row + d * x;
+					q[0] = p[0]; q[1] = p[1]; q[2] = p[2];
+				}
+			}
+		}
+
+		void draw_image(int left, int top, const ImageView& src) override
+		{
+			auto const r = Rect{ left, top, left + src.width, top + src.height } & bounds();
+			if (r.is_empty()) return;
+			int const d = dst.depth;
+			for (int y = r.top; y < r.bottom; y++) {
+				const byte* const s = src.row(y - top) + 3 * (r.left - left);
+				byte* const row = dst.row(y) + d * r.left;
+				if (d == 3) std::memcpy(row, s, 3 * static_cast<size_t>(r.width()));
+				else for (int i = 0; i < r.width(); i++) {
+					row[4 * i] = s[3 * i]; row[4 * i + 1] = s[3 * i + 1]; row[4 * i + 2] = s[3 * i + 2];
+				}
+			}
+		}
+	};
+}
@@ -0,0 +1,222 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+#include "image_basics.hpp"
+#include "frame_alloc.hpp"
+
+////////////////////////////////
+// 丸角矩形のスプライトキャッシュ．
+////////////////////////////////
+namespace sigma_lib::image
+{
+	// keeps pre-rendered rounded rects with their frames and gradations,
+	// so the chrome of the tips and toasts is drawn by copying a sprite.
+	// the shape is rendered in the same way as draw_round_rect() with GDI,
+	// though the pixels at the corners might differ slightly.
+	class ChromeSprites {
+	public:
+		// the parameters that determine the image. colors are of COLORREF.
+		struct Key {
+			int width = 0, height = 0, corner = 0, thick = 0;
+			uint32_t back_top = 0, back_bottom = 0, chrome = 0;
+			constexpr bool operator==(const Key&) const = default;
+		};
+		struct Stats {
+			uint32_t hits, misses;
+			size_t bytes;	// bytes the sprites currently use.
+		};
+
+		constexpr static int max_sprites = 8;
+		constexpr static size_t default_budget = size_t{ 1 } << 20;
+
+	private:
+		struct Sprite {
+			FrameAllocator pool{ 0 };
+			Key key{};
+			uint32_t last_used = 0;
+
+			// the image including the frame, and the opaque span [left, right) of each row.
+			ImageView pixels{};
+			int32_t* spans = nullptr;
+
+			constexpr bool is_valid() const { return spans != nullptr; }
+			size_t bytes() const { return pool.stats().capacity; }
+			void free() { pool.release(); pixels = {}; spans = nullptr; }
+		} sprites[max_sprites]{};
+		size_t budget = default_budget;
+		uint32_t clock = 0, hits = 0, misses = 0;
+
+		static void put(byte* p, uint32_t colorref) {
+			p[0] = static_cast<byte>(colorref >> 16);
+			p[1] = static_cast<byte>(colorref >> 8);
+			p[2] = static_cast<byte>(colorref);
+		}
+
+		// the inset of the row `y` from the sides of the rounded rect of `w` x `h`,
+		// whose corners are the quarters of the ellipse of `corner` x `corner` clamped into the rect.
+		static int inset(int y, int w, int h, int corner)
+		{
+			double const ax = std::min(corner, w) / 2.0, ay = std::min(corner, h) / 2.0;
+			if (ax < 1 || ay < 1) return 0;
+			double const dy = ay - (std::min(y, h - 1 - y) + 0.5);
+			if (dy <= 0) return 0;
+			return static_cast<int>(ax - ax * std::sqrt(1 - (dy / ay) * (dy / ay)) + 0.5);
+		}
+
+		// interpolates a channel of the vertical gradation, like GdiGradientFill() with 16 bits per channel.
+		static uint32_t gradation(uint32_t top, uint32_t bottom, int y, int h)
+		{
+			uint32_t c = 0;
+			for (int sh = 0; sh < 24; sh += 8) {
+				int const t = ((top >> sh) & 0xff) << 8, b = ((bottom >> sh) & 0xff) << 8;
+				c |= static_cast<uint32_t>((t + (b - t) * y / h) >> 8) << sh;
+			}
+			return c;
+		}
+
+		// draws the image in the same manner as draw_round_rect().
+		// with the null pen, RoundRect() fills one pixel less to the right and to the bottom.
+		static void render(Sprite& s, const Key& key)
+		{
+			int const t = std::max(key.thick, 0),
+				W = key.width + 2 * t, H = key.height + 2 * t;
+			auto const stride = ImageView::stride_of(W);
+			size_t const sz_pix = stride * H, sz_spans = sizeof(int32_t) * 2 * H;
+			auto p = static_cast<byte*>(s.pool.allocate(sz_pix + sz_spans));
+			if (p == nullptr) { s.free(); return; }
+			s.pixels = { p, W, H, stride };
+			s.spans = reinterpret_cast<int32_t*>(p + sz_pix);
+			s.key = key;
+
+			int const corner = t > 0 ? std::max(0, key.corner - 2 * t) : key.corner;
+			for (int y = 0; y < H; y++) {
+				byte* const row = s.pixels.row(y);
+				int32_t* const span = s.spans + 2 * y;
+				span[0] = span[1] = 0;
+
+				// the frame.
+				if (t > 0 && y < H - 1) {
+					int const d = inset(y, W - 1, H - 1, key.corner);
+					span[0] = d; span[1] = W - 1 - d;
+					for (int x = span[0]; x < span[1]; x++) put(row + 3 * x, key.chrome);
+				}
+
+				// the gradation inside.
+				int const yi = y - t;
+				if (yi < 0 || yi >= key.height - 1) continue;
+				int const d = inset(yi, key.width - 1, key.height - 1, corner),
+					l = t + d, r = t + key.width - 1 - d;
+				auto const color = gradation(key.back_top, key.back_bottom, yi, key.height);
+				for (int x = l; x < r; x++) put(row + 3 * x, color);
+				if (t == 0) span[0] = l, span[1] = r;
+			}
+		}
+
+		// frees the least recently used sprite. returns false if none.
+		bool evict()
+		{
+			Sprite* lru = nullptr;
+			for (auto& s : sprites) {
+				if (s.is_valid() && (lru == nullptr || s.last_used < lru->last_used)) lru = &s;
+			}
+			if (lru == nullptr) return false;
+			lru->free();
+			return true;
+		}
+
+		// finds the sprite for the key, or renders one evicting the least recently used.
+		const Sprite* find(const Key& key)
+		{
+			Sprite* victim = nullptr;
+			for (auto& s : sprites) {
+				if (s.is_valid() && s.key == key) {
+					s.last_used = ++clock;
+					hits++;
+					return &s;
+				}
+				if (victim == nullptr || !s.is_valid() ||
+					(victim->is_valid() && s.last_used < victim->last_used)) victim = &s;
+			}
+			misses++;
+
+			// keep the total size within the budget, counted in the committed pages as bytes() does.
+			int const t = std::max(key.thick, 0);
+			size_t const need = victim->pool.capacity_for(
+				(ImageView::stride_of(key.width + 2 * t) + 2 * sizeof(int32_t)) * (key.height + 2 * t));
+			if (need > budget) return nullptr;
+			victim->free();
+			while (bytes() + need > budget && evict()) {}
+
+			render(*victim, key);
+			if (!victim->is_valid()) return nullptr;
+			victim->last_used = ++clock;
+			return victim;
+		}
+
+	public:
+		// draws the rounded rect whose inner area is `key.width` x `key.height` at (`left`, `top`),
+		// with the frame of `key.thick` around it. `dst` can be of 32bpp.
+		// returns false if the sprite isn't available, in which case nothing is drawn.
+		bool draw(const ImageView& dst, int left, int top, const Key& key)
+		{
+			if (key.width <= 0 || key.height <= 0) return true;
+			auto const* s = find(key);
+			if (s == nullptr) return false;
+
+			int const t = std::max(key.thick, 0);
+			left -= t; top -= t;
+			int const y0 = std::max(0, -top), y1 = std::min(s->pixels.height, dst.height - top);
+			for (int y = y0; y < y1; y++) {
+				int const l = std::max(s->spans[2 * y], -left),
+					r = std::min(s->spans[2 * y + 1], dst.width - left);
+				if (l >= r) continue;
+				byte* const d = dst.row(top + y) + dst.depth * (left + l);
+				const byte* const p = s->pixels.row(y) + 3 * l;
+				if (dst.depth == 3) std::memcpy(d, p, 3 * static_cast<size_t>(r - l));
+				else for (int i = 0; i < r - l; i++) {
+					d[4 * i] = p[3 * i]; d[4 * i + 1] = p[3 * i + 1]; d[4 * i + 2] = p[3 * i + 2];
+				}
+			}
+			return true;
+		}
+
+		// limits the total bytes of the sprites.
+		void set_budget(size_t bytes)
+		{
+			budget = bytes;
+			while (this->bytes() > budget && evict()) {}
+		}
+
+		size_t bytes() const
+		{
+			size_t sum = 0;
+			for (auto& s : sprites) sum += s.bytes();
+			return sum;
+		}
+		Stats stats() const { return { hits, misses, bytes() }; }
+
+		void release()
+		{
+			for (auto& s : sprites) s.free();
+		}
+	};
+}
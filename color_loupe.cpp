@@ -16,6 +16,7 @@ THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR I
 #include <tuple>
 #include <cwchar>
 #include <concepts>
+#include <memory>
 
 #define NOMINMAX
 #define WIN32_LEAN_AND_MEAN
@@ -33,6 +34,27 @@ using namespace sigma_lib::W32::GDI;
 using namespace sigma_lib::W32::UI;
 #include "drag_states.hpp"
 using namespace sigma_lib::W32::custom::mouse;
+#include "image_basics.hpp"
+#include "loupe_view.hpp"
+#include "image_ingest.hpp"
+#include "frame_borrow.hpp"
+#include "image_buffer.hpp"
+#include "frame_alloc.hpp"
+#include "mipmap.hpp"
+#include "upscale.hpp"
+#include "grid_raster.hpp"
+#include "grid_lines.hpp"
+#include "chrome_sprite.hpp"
+#include "glyph_atlas.hpp"
+#include "text_format.hpp"
+#include "overlay.hpp"
+#include "region_stats.hpp"
+#include "histogram.hpp"
+#include "frame_diff.hpp"
+#include "lut3d.hpp"
+#include "color_space.hpp"
+using namespace sigma_lib::image;
+static_assert(sizeof(Rect) == sizeof(RECT));
 
 #include "resource.hpp"
 #include "settings.hpp"
@@ -56,41 +78,8 @@ static inline constinit struct LoupeState {
 	} position{ 0,0 };
 
 	// zoom --- manages the scaling ratio of zooming.
-	struct Zoom {
-		int zoom_level, second_level;
-		constexpr static int zoom_level_min = -17, zoom_level_max = 24;
-
-	private:
-		constexpr static int scale_denominator = 4;
-		static constexpr int scale_base(int level) {
-			return (4 + (level & 3)) << (level >> 2);
-		}
-	public:
-		static constexpr double scale_ratio(int scale_level) { return scale_level >= 0 ? scale_level == 0 ? 1 : upscale(scale_level) : 1 / downscale(scale_level); }
-		static constexpr double scale_ratio_inv(int scale_level) { return scale_level >= 0 ? scale_level == 0 ? 1 : 1 / upscale(scale_level) : downscale(scale_level); }
-		static constexpr auto scale_ratios(int scale_level) {
-			double s;
-			return scale_level >= 0 ? scale_level == 0 ? std::make_pair(1.0, 1.0) :
-				((s = upscale(scale_level)), std::make_pair(s, 1 / s)) :
-				((s=downscale(scale_level)), std::make_pair(1 / s, s));
-		}
-		static constexpr auto scale_ratio_Q(int zoom_level)
-		{
-			int n = scale_denominator, d = scale_denominator;
-			if (zoom_level < 0) d = scale_base(-zoom_level);
-			else n = scale_base(zoom_level);
-			// as of either the numerator or the denominator is a power of 2, so is the GCD.
-			auto gcd = n | d; gcd &= -gcd; // = std::gcd(n, d);
-			return std::make_pair(n / gcd, d / gcd);
-		}
-		static constexpr double upscale(int zoom_level) { return (1.0 / scale_denominator) * scale_base(zoom_level); }
-		static constexpr double downscale(int zoom_level) { return upscale(-zoom_level); }
-
-		constexpr double scale_ratio() const { return scale_ratio(zoom_level); }
-		constexpr double scale_ratio_inv() const { return scale_ratio_inv(zoom_level); }
-		constexpr auto scale_ratios() const { return scale_ratios(zoom_level); }
-		constexpr auto scale_ratio_Q() const { return scale_ratio_Q(zoom_level); }
-	} zoom{ 8, 0 };
+	using Zoom = LoupeZoom;
+	Zoom zoom{ 8, 0 };
 
 	// tip --- tooltip-like info.
 	struct Tip {
@@ -112,6 +101,20 @@ static inline constinit struct LoupeState {
 		bool visible = false;
 	} grid;
 
+	struct {
+		bool visible = false;
+	} histogram;
+
+	// shows the differences from the previous frame instead of the image.
+	struct {
+		bool visible = false;
+	} difference;
+
+	// shows the image through the 3D LUT.
+	struct {
+		bool visible = false;
+	} lut;
+
 	////////////////////////////////
 	// coordinate transforms.
 	////////////////////////////////
@@ -145,26 +148,9 @@ static inline constinit struct LoupeState {
 	// and view port may cover beyond the window corners.
 	std::pair<RECT, RECT> viewbox_viewport(int picture_w, int picture_h, int client_w, int client_h) const
 	{
-		auto [p2w, w2p] = transforms();
-		auto [pl, pt] = w2p(-0.5 * client_w, -0.5 * client_h);
-		auto [pr, pb] = w2p(+0.5 * client_w, +0.5 * client_h);
-		pl = std::max<double>(std::floor(pl), 0);
-		pt = std::max<double>(std::floor(pt), 0);
-		pr = std::min<double>(std::ceil(pr), picture_w);
-		pb = std::min<double>(std::ceil(pb), picture_h);
-
-		auto [wl, wt] = p2w(pl, pt);
-		auto [wr, wb] = p2w(pr, pb);
-		wl = std::floor(0.5 + wl + 0.5 * client_w);
-		wt = std::floor(0.5 + wt + 0.5 * client_h);
-		wr = std::floor(0.5 + wr + 0.5 * client_w);
-		wb = std::floor(0.5 + wb + 0.5 * client_h);
-
-		constexpr auto i = [](double x) { return static_cast<int>(x); };
-		return {
-			{ i(pl), i(pt), i(pr), i(pb) },
-			{ i(wl), i(wt), i(wr), i(wb) },
-		};
+		auto const [vb, vp] = sigma_lib::image::viewbox_viewport(zoom, position.x, position.y,
+			picture_w, picture_h, client_w, client_h);
+		return { std::bit_cast<RECT>(vb), std::bit_cast<RECT>(vp) };
 	}
 
 	////////////////////////////////
@@ -227,6 +213,10 @@ static inline void load_settings()
 		loupe_state.position.follow_cursor ? 1 : 0, path) != 0;
 	loupe_state.grid.visible = ::GetPrivateProfileIntA("state", "show_grid",
 		loupe_state.position.follow_cursor ? 1 : 0, path) != 0;
+	loupe_state.histogram.visible = ::GetPrivateProfileIntA("state", "show_histogram",
+		loupe_state.histogram.visible ? 1 : 0, path) != 0;
+	loupe_state.difference.visible = ::GetPrivateProfileIntA("state", "show_difference",
+		loupe_state.difference.visible ? 1 : 0, path) != 0;
 }
 static inline void save_settings()
 {
@@ -245,83 +235,140 @@ static inline void save_settings()
 		loupe_state.position.follow_cursor ? "1" : "0", path);
 	::WritePrivateProfileStringA("state", "show_grid",
 		loupe_state.grid.visible ? "1" : "0", path);
+	::WritePrivateProfileStringA("state", "show_histogram",
+		loupe_state.histogram.visible ? "1" : "0", path);
+	::WritePrivateProfileStringA("state", "show_difference",
+		loupe_state.difference.visible ? "1" : "0", path);
 }
 
 
 ////////////////////////////////
 // 画像バッファ．
 ////////////////////////////////
-static inline constinit class ImageBuffer {
-	BITMAPINFO bi{
-		.bmiHeader = {
-			.biSize = sizeof(bi.bmiHeader),
-			.biPlanes = 1,
-			.biBitCount = 24,
-			.biCompression = BI_RGB,
-		},
-	};
+static inline constinit ImageBuffer image{};
 
-	void* buf = nullptr;
-	template<class TSelf>
-	constexpr auto& wd(this TSelf& self) { return self.bi.bmiHeader.biWidth; }
-	template<class TSelf>
-	constexpr auto& ht(this TSelf& self) { return self.bi.bmiHeader.biHeight; }
+// 画像データの取得元．
+static inline constinit struct {
+	FilterPlugin* fp = nullptr;
+	EditHandle* editp = nullptr;
 
-	void reallocate(int w, int h)
+	// returns the frame currently displayed if its size matches, or nullptr.
+	const void* operator()(int w, int h) const
 	{
-		int size_next = stride(w) * h, size_curr = stride() * ht();
-		wd() = w; ht() = h;
-
-		if (size_next == size_curr) return;
-		if (buf != nullptr) ::VirtualFree(buf, 0, MEM_RELEASE);
-		buf = size_next > 0 ? ::VirtualAlloc(nullptr, size_next, MEM_COMMIT, PAGE_READWRITE) : nullptr;
+		if (fp == nullptr || editp == nullptr ||
+			!fp->exfunc->is_editing(editp) || fp->exfunc->is_saving(editp) ||
+			editp->w1 != w || editp->h1 != h) return nullptr;
+		return fp->exfunc->get_disp_pixelp(editp, 0);
 	}
+} frame_source;
 
-public:
-	constexpr const void* buffer() const { return buf; }
-	constexpr const BITMAPINFO& info() const { return bi; }
-	constexpr auto width() const { return wd(); }
-	constexpr auto height() const { return ht(); }
+// 縮小表示用のミップマップ．
+static constinit MipPyramid mipmap{};
 
-	static constexpr int stride(int width) {
-		// rounding upward into a multiple of 4.
-		return (3 * width + 3) & (-4);
-	}
-	constexpr int stride() const { return stride(width()); }
+// 範囲内の色の統計．
+static constinit RegionStats region_stats{};
+
+// 表示範囲のヒストグラム．
+static constinit Histogram histogram{};
+
+// 前フレームとの差分表示．
+static constinit FrameDiff frame_diff{};
 
-	Color color_at(int x, int y) const
+// the histogram and the adaptive grid count the luma by the same weights as Color::luma(),
+// and the grid takes the upper 8 bits of 128 or above for beyond the half of the maximum.
+static_assert(Color::luma(1, 0, 0) == sigma_lib::color_space::color_luma(1, 0, 0) &&
+	Color::luma(0, 1, 0) == sigma_lib::color_space::color_luma(0, 1, 0) &&
+	Color::luma(0, 0, 1) == sigma_lib::color_space::color_luma(0, 0, 1));
+static_assert(Color::max_luma / 2 + 1 == 128 << 8);
+
+// 3D LUT を通した表示．
+static constinit Lut3D lut{};
+
+// whether the color format shows the statistics around the pixel rather than the pixel itself.
+constexpr bool uses_region_stats(Settings::ColorFormat fmt)
+{
+	using enum Settings::ColorFormat;
+	return fmt == mean_hexdec6 || fmt == stats_dec3x3;
+}
+// puts "%s(%d,%d,%d)" of the color in the color space of `fmt`, where the numbers are in tenths for L*a*b* and L*C*h.
+// `pad` aligns the numbers to their widest. returns 0 if `fmt` isn't of the other color spaces.
+static int put_color_space(wchar_t* buf, Settings::ColorFormat fmt, Color color, bool pad)
+{
+	using namespace sigma_lib::format;
+	namespace cs = sigma_lib::color_space;
+	const wchar_t* label;
+	int v[3];
+	bool tenths = false;
+	switch (fmt) {
+		using enum Settings::ColorFormat;
+	case hsv:
 	{
-		if (buf == nullptr ||
-			x < 0 || y < 0 || x >= wd() || y >= ht()) return CLR_INVALID;
-		auto ptr = reinterpret_cast<byte*>(buf) + 3 * x + stride() * (ht() - 1 - y);
-		return { ptr[2], ptr[1], ptr[0] };
+		auto const c = cs::to_hsv(color.R, color.G, color.B);
+		label = L"HSV("; v[0] = c.h; v[1] = c.s; v[2] = c.v;
+		break;
 	}
-
-	// returns true if the image size has been changed.
-	bool update(int w, int h, void* source)
+	case hls:
 	{
-		// check for size changes to the image.
-		bool size_changed = false;
-		if (wd() != w || ht() != h)
-		{
-			size_changed = true;
-			reallocate(w, h);
-		}
-
-		std::memcpy(buf, source, stride() * ht());
-		return size_changed;
+		auto const c = cs::to_hls(color.R, color.G, color.B);
+		label = L"HLS("; v[0] = c.h; v[1] = c.l; v[2] = c.s;
+		break;
 	}
-
-	void free()
+	case ycbcr601:
+	case ycbcr709:
 	{
-		if (buf != nullptr) {
-			::VirtualFree(buf, 0, MEM_RELEASE), buf = nullptr;
-			wd() = ht() = 0;
-		}
+		auto const c = cs::to_ycbcr(color.R, color.G, color.B,
+			fmt == ycbcr709 ? cs::Matrix::bt709 : cs::Matrix::bt601);
+		label = L"YCbCr("; v[0] = c.y; v[1] = c.cb; v[2] = c.cr;
+		break;
+	}
+	case lab:
+	{
+		auto const c = cs::to_lab(color.R, color.G, color.B);
+		label = L"Lab("; v[0] = c.l; v[1] = c.a; v[2] = c.b; tenths = true;
+		break;
+	}
+	case lch:
+	{
+		auto const c = cs::to_lch(color.R, color.G, color.B);
+		label = L"LCh("; v[0] = c.l; v[1] = c.c; v[2] = c.h; tenths = true;
+		break;
+	}
+	default: return 0;
 	}
 
-	bool is_valid() const { return buf != nullptr; }
-} image;
+	int len = put(buf, label);
+	for (int i = 0; i < 3; i++) {
+		if (i > 0) buf[len++] = L',';
+		len += tenths ? put_tenths(buf + len, v[i], pad ? 5 : 0) : put_int(buf + len, v[i], pad ? 3 : 0);
+	}
+	buf[len++] = L')';
+	return len;
+}
+// the area of the image the tip reads the colors from.
+static inline Rect tip_region()
+{
+	constexpr auto& tip = loupe_state.tip;
+	if (!uses_region_stats(settings.tip_drag.color_fmt)) return { tip.x, tip.y, tip.x + 1, tip.y + 1 };
+	return RegionStats::neighborhood(tip.x, tip.y, settings.tip_drag.stats_size);
+}
+
+// 拡大表示用の描画バッファ．
+static constinit Upscaler upscaler{};
+
+// グリッドのソフトウェア描画．
+static constinit GridRaster grid_raster{};
+
+// 色・座標表示や通知メッセージの背景．
+static constinit ChromeSprites chrome_sprites{};
+
+// ソフトウェア描画の並列処理．
+static constinit StripPool strip_pool{};
+// returns the pool for the software drawings, or nullptr if single-threaded.
+static inline StripPool* strips()
+{
+	strip_pool.set_threads(settings.performance.render_threads);
+	return strip_pool.threads() > 1 ? &strip_pool : nullptr;
+}
 
 
 ////////////////////////////////
@@ -369,6 +416,9 @@ static constinit Handle<HFONT,
 	tip_font{ &settings.tip_drag.font_name, &settings.tip_drag.font_size },
 	toast_font{ &settings.toast.font_name, &settings.toast.font_size };
 
+// the glyphs of the fonts above, freed together with the fonts.
+static constinit GlyphAtlas tip_glyphs{}, toast_glyphs{};
+
 static constinit Handle<HMENU, [] { return ::LoadMenuW(this_dll, MAKEINTRESOURCEW(IDR_MENU_CXT)); }, ::DestroyMenu>
 	cxt_menu{};
 
@@ -418,11 +468,15 @@ static inline constinit class ToastManager {
 		if (toast.visible) {
 			toast.visible = false;
 			if (hwnd != nullptr)
-				::PostMessageW(hwnd, WM_PAINT, {}, {}); // ::InvalidateRect() caused flickering.
+				::PostMessageW(hwnd, msg_erased, {}, {}); // ::InvalidateRect() caused flickering.
 		}
 	}
 
 public:
+	// posted to the host window when the toast has gone, to redraw the loupe.
+	// unlike WM_PAINT, the areas except the toast are known to be on the screen.
+	constexpr static UINT msg_erased = WM_APP + 1;
+
 	bool is_active() const { return active; }
 	HWND host_window() const { return hwnd; }
 
@@ -455,6 +509,111 @@ public:
 } toast_manager;
 
 
+////////////////////////////////
+// 未使用メモリの解放．
+////////////////////////////////
+// releases the excess capacity of the frame buffers once the loupe has been idle for a while,
+// as their allocators trim only by the ticks of incoming frames.
+static inline constinit class IdleTrimmer {
+	HWND hwnd = nullptr;
+	constexpr static int idle_ms = 2000;
+
+	auto timer_id() const { return reinterpret_cast<uintptr_t>(this); }
+	static void CALLBACK timer_proc(HWND hwnd, auto, uintptr_t id, auto)
+	{
+		// turn the timer off.
+		::KillTimer(hwnd, id);
+
+		auto* that = reinterpret_cast<IdleTrimmer*>(id);
+		if (that == nullptr || that->hwnd != hwnd) return; // might be a wrong call.
+		that->hwnd = nullptr;
+
+		image.trim();
+		upscaler.trim();
+	}
+
+public:
+	// restarts the countdown. call this on each draw.
+	void postpone(HWND hwnd)
+	{
+		if (this->hwnd != nullptr && this->hwnd != hwnd) stop();
+		this->hwnd = hwnd;
+		::SetTimer(hwnd, timer_id(), idle_ms, timer_proc);
+		// WM_TIMER won't be posted to the window procedure.
+	}
+	void stop()
+	{
+		if (hwnd != nullptr) {
+			::KillTimer(hwnd, timer_id());
+			hwnd = nullptr;
+		}
+	}
+} idle_trimmer;
+
+
+////////////////////////////////
+// 描画バッファ．
+////////////////////////////////
+// the back buffer of the loupe window, kept across draws.
+// it's of 32bpp as the screen is, so presenting it is a plain copy.
+static constinit DIBSurface back_buffer{ 4 };
+
+// layered cache of the drawing, each layer redrawn only when its state changes.
+static inline constinit struct Compositor {
+	struct Layer {
+		DIBSurface surface{};
+		uint32_t epoch = 0; // incremented every time the layer is redrawn.
+		uint32_t hits = 0, misses = 0;
+		bool valid = false;
+
+		void free() { surface.release(); valid = false; }
+	};
+
+	// the backplane and the image.
+	struct : Layer {
+		int zoom_level = 0, mip_level = 0;
+		bool upscale = false;
+		Rect vb{}, vp{};
+		COLORREF blank = CLR_INVALID;
+	} picture;
+
+	// the grid over the picture.
+	struct : Layer {
+		uint32_t picture_epoch = 0;
+		uint8_t grid_thick = 0;
+	} scene;
+
+	// the tip and the toast over the scene, which live in the back buffer.
+	struct {
+		struct Key {
+			uint32_t picture_epoch = 0, scene_epoch = 0;
+			uint8_t grid_thick = 0;
+			bool tip = false, prefer_above = false, toast = false;
+			Rect tip_box{};
+			int tip_x = 0, tip_y = 0;
+			COLORREF tip_color = CLR_INVALID;
+			RegionStats::Stats tip_stats{};
+			bool histogram = false;
+			uint32_t histogram_epoch = 0;
+			wchar_t message[LoupeState::Toast::max_len_message]{};
+			constexpr bool operator==(const Key&) const = default;
+		} key{};
+		// the areas the histogram, the tip and the toast were drawn at.
+		RECT histogram_rc{}, tip_rc{}, toast_rc{};
+		uint32_t hits = 0, misses = 0;
+		bool valid = false;
+	} overlay;
+
+	// discards every layer.
+	void invalidate() { picture.valid = scene.valid = overlay.valid = false; }
+	// discards the layers affected by the change of the image within `dirty`.
+	void invalidate(const Rect& dirty) {
+		if (dirty.intersects(picture.vb)) picture.valid = false;
+	}
+	void free() { picture.free(); scene.free(); overlay.valid = false; }
+} compositor;
+
+
 ////////////////////////////////
 // 外部リソース管理．
 ////////////////////////////////
@@ -473,8 +632,21 @@ public:
 	void free()
 	{
 		image.free();
+		mipmap.release();
+		region_stats.release();
+		histogram.release();
+		frame_diff.release();
+		lut.release();
+		upscaler.release();
+		grid_raster.release();
+		chrome_sprites.release();
+		strip_pool.release();
+		compositor.free();
+		back_buffer.release();
 		tip_font.free();
 		toast_font.free();
+		tip_glyphs.release();
+		toast_glyphs.release();
 		cxt_menu.free();
 		toast_manager.erase();
 	}
@@ -485,100 +657,205 @@ public:
 // 描画関数．
 ////////////////////////////////
 
+// the pixels of the 24bpp or 32bpp DIB section selected into `hdc`, if any.
+static inline bool dib_view_of(HDC hdc, ImageView& view)
+{
+	DIBSECTION ds;
+	if (::GetObjectW(::GetCurrentObject(hdc, OBJ_BITMAP), sizeof(ds), &ds) != sizeof(ds) ||
+		ds.dsBm.bmBits == nullptr || (ds.dsBm.bmBitsPixel != 24 && ds.dsBm.bmBitsPixel != 32) ||
+		ds.dsBmih.biHeight <= 0 || ds.dsBmih.biCompression != BI_RGB) return false;
+	view = { static_cast<byte*>(ds.dsBm.bmBits), ds.dsBm.bmWidth, ds.dsBm.bmHeight,
+		static_cast<size_t>(ds.dsBm.bmWidthBytes), ds.dsBm.bmBitsPixel / 8 };
+	return true;
+}
+
+// calls `draw(canvas)` with the canvas onto `hdc`; onto the pixels of its DIB section
+// without GDI if enabled and available.
+static inline void draw_on(HDC hdc, auto&& draw)
+{
+	if (ImageView dib; settings.performance.raster_canvas && dib_view_of(hdc, dib)) {
+		// let GDI finish drawing before touching the pixels.
+		::GdiFlush();
+		RasterCanvas canvas{ dib };
+		draw(static_cast<Canvas&>(canvas));
+	}
+	else {
+		GdiCanvas canvas{ hdc };
+		draw(static_cast<Canvas&>(canvas));
+	}
+}
+
 // 背景描画．
-static inline void draw_backplane(HDC hdc, const RECT& rc)
+static inline void draw_backplane(Canvas& canvas, const RECT& rc)
+{
+	draw_backplane(canvas, std::bit_cast<Rect>(rc), settings.color.blank);
+}
+
+// the pixels of the image for the software drawings.
+static inline ImageView image_view()
+{
+	return { static_cast<byte*>(const_cast<void*>(image.buffer())),
+		image.width(), image.height(), static_cast<size_t>(image.stride()) };
+}
+// the pixels to draw as the picture; the differences from the previous frame in the difference view,
+// which cover only the view box, or the image through the LUT if it's applied.
+static inline Picture picture_view()
+{
+	if (loupe_state.difference.visible && frame_diff.heatmap().bits != nullptr)
+		return { frame_diff.heatmap(), frame_diff.heatmap_area().left, frame_diff.heatmap_area().top };
+	if (loupe_state.lut.visible && lut.output().bits != nullptr)
+		return { lut.output() };
+	return { image_view() };
+}
+// the color as shown in the view when `transformed` is requested, that is, through the LUT if it's applied.
+static inline Color view_color(Color color, bool transformed)
 {
-	::SetDCBrushColor(hdc, settings.color.blank);
-	::FillRect(hdc, &rc, static_cast<HBRUSH>(::GetStockObject(DC_BRUSH)));
+	if (!transformed || !loupe_state.lut.visible || color.A != 0) return color;
+	byte const src[] = { color.B, color.G, color.R };
+	byte dst[3];
+	lut.map(src, dst);
+	return { dst[2], dst[1], dst[0] };
 }
 
 // 画像描画．
-static inline void draw_picture(HDC hdc, const RECT& vb, const RECT& vp)
+static inline void draw_picture(Canvas& canvas, const RECT& vb, const RECT& vp, int mip_level)
 {
-	::SetStretchBltMode(hdc, STRETCH_DELETESCANS);
-	::StretchDIBits(hdc, vp.left, vp.top, vp.right - vp.left, vp.bottom - vp.top,
-		vb.left, image.height() - vb.bottom, vb.right - vb.left, vb.bottom - vb.top,
-		image.buffer(), &image.info(), DIB_RGB_COLORS, SRCCOPY);
+	draw_picture(canvas, picture_view(), std::bit_cast<Rect>(vb), std::bit_cast<Rect>(vp), mipmap, mip_level);
 }
 
-// グリッド描画 (thin)
-static inline void draw_grid_thin(HDC hdc, const RECT& vb, const RECT& vp)
+// 画像描画 (software upscaling)
+static inline void draw_picture_upscaled(Canvas& canvas, const RECT& rc, const RECT& vb, const RECT& vp)
 {
-	int w = vb.right - vb.left, W = vp.right - vp.left,
-		h = vb.bottom - vb.top, H = vp.bottom - vp.top;
+	draw_picture_upscaled(canvas, upscaler, picture_view(),
+		std::bit_cast<Rect>(rc), std::bit_cast<Rect>(vb), std::bit_cast<Rect>(vp), strips());
+}
 
-	auto old_mode = ::SetROP2(hdc, R2_NOT);
-	for (int x = vb.left; x < vb.right; x++) {
-		auto X = (x - vb.left) * W / w + vp.left;
-		::MoveToEx(hdc, X, vp.top, nullptr);
-		::LineTo(hdc, X, vp.bottom);
-	}
-	for (int y = vb.top; y < vb.bottom; y++) {
-		auto Y = (y - vb.top) * H / h + vp.top;
-		::MoveToEx(hdc, vp.left, Y, nullptr);
-		::LineTo(hdc, vp.right, Y);
+// グリッドの色 (thick), from the most significant lines to the least.
+constexpr uint32_t grid_thick_colors[] = {
+	0x222222, 0x444444, 0x666666,
+	Color{ 0x666666 }.negate().raw, Color{ 0x444444 }.negate().raw, Color{ 0x222222 }.negate().raw,
+};
+
+// グリッド描画．draws directly onto the pixels of `surface` when enabled and available.
+// the colors adapting to the picture need `surface`, falling back to the usual grid without it.
+static inline void draw_grid(HDC hdc, const DIBSurface* surface, const RECT& vb, const RECT& vp, uint8_t grid_thick)
+{
+	if (grid_thick == 0) return;
+	if ((settings.performance.grid_raster || settings.grid.adaptive) &&
+		surface != nullptr && surface->is_valid()) {
+		// keep the tiles no more than the integer scales that show the grid.
+		int num_scales = 0;
+		for (int z = settings.grid.least_zoom_thin; z <= LoupeState::Zoom::zoom_level_max; z++)
+			num_scales += LoupeState::Zoom::scale_ratio_Q(z).second == 1 ? 1 : 0;
+		grid_raster.set_tile_capacity(num_scales);
+
+		// let GDI finish drawing before touching the pixels.
+		::GdiFlush();
+		if (settings.grid.adaptive) {
+			// dark lines over bright pixels, light lines over dark pixels.
+			auto const pic = picture_view();
+			grid_raster.draw_adaptive(surface->view(), pic.view,
+				pic.source(std::bit_cast<Rect>(vb)), std::bit_cast<Rect>(vp), grid_thick, grid_thick_colors);
+		}
+		else grid_raster.draw(surface->view(), std::bit_cast<Rect>(vb), std::bit_cast<Rect>(vp),
+			grid_thick, grid_thick_colors, strips());
+		return;
 	}
-	::SetROP2(hdc, old_mode);
+	draw_on(hdc, [&](Canvas& canvas) {
+		if (grid_thick == 1) draw_grid_thin(canvas, std::bit_cast<Rect>(vb), std::bit_cast<Rect>(vp));
+		else draw_grid_thick(canvas, std::bit_cast<Rect>(vb), std::bit_cast<Rect>(vp), grid_thick_colors);
+	});
+}
+
+// 画像レイヤーの更新．
+// reuses the previous drawing when scrolled by whole screen pixels at integer scales.
+static inline const auto& compose_picture(const RECT& rc, const RECT& vb, const RECT& vp, int mip_level, bool upscale)
+{
+	auto& layer = compositor.picture;
+	int const wd = rc.right, ht = rc.bottom;
+	bool const kept = !layer.surface.resize(wd, ht) && layer.valid,
+		same_look = layer.zoom_level == loupe_state.zoom.zoom_level && layer.mip_level == mip_level &&
+			layer.upscale == upscale && layer.blank == settings.color.blank;
+	if (kept && same_look && layer.vb == std::bit_cast<Rect>(vb) && layer.vp == std::bit_cast<Rect>(vp)) {
+		layer.hits++;
+		return layer;
+	}
+	layer.misses++; layer.epoch++;
+
+	// only integer scales map the pixels to the screen by pure translation.
+	auto const [n, d] = loupe_state.zoom.scale_ratio_Q();
+
+	// draws the part of the picture that covers the `area` onto the layer.
+	auto const draw_area = [&](const RECT& area) { draw_on(layer.surface.hdc(), [&](Canvas& canvas) {
+		draw_backplane(canvas, area);
+		if (d != 1) {
+			if (upscale) draw_picture_upscaled(canvas, area, vb, vp);
+			else draw_picture(canvas, vb, vp, mip_level);
+			return;
+		}
+
+		auto const [sub_vb, sub_vp] = sub_viewbox_viewport(std::bit_cast<Rect>(area),
+			std::bit_cast<Rect>(vb), std::bit_cast<Rect>(vp), n);
+		if (sub_vb.is_empty()) return;
+		if (upscale) draw_picture_upscaled(canvas, area, std::bit_cast<RECT>(sub_vb), std::bit_cast<RECT>(sub_vp));
+		else draw_picture(canvas, std::bit_cast<RECT>(sub_vb), std::bit_cast<RECT>(sub_vp), 0);
+	}); };
+
+	auto const [dx, dy] = scroll_offset(layer.vb, layer.vp, std::bit_cast<Rect>(vb), std::bit_cast<Rect>(vp), n);
+	if (kept && same_look && settings.performance.scroll_reuse && d == 1 &&
+		std::abs(dx) < wd && std::abs(dy) < ht) {
+		// shift the previous drawing and fill the exposed strips.
+		::BitBlt(layer.surface.hdc(), dx, dy, wd, ht, layer.surface.hdc(), 0, 0, SRCCOPY);
+		auto const [strip_x, strip_y] = exposed_strips(dx, dy, wd, ht);
+		if (!strip_x.is_empty()) draw_area(std::bit_cast<RECT>(strip_x));
+		if (!strip_y.is_empty()) draw_area(std::bit_cast<RECT>(strip_y));
+	}
+	else draw_area(rc);
+
+	layer.zoom_level = loupe_state.zoom.zoom_level;
+	layer.mip_level = mip_level;
+	layer.upscale = upscale;
+	layer.vb = std::bit_cast<Rect>(vb); layer.vp = std::bit_cast<Rect>(vp);
+	layer.blank = settings.color.blank;
+	layer.valid = true;
+	return layer;
 }
 
-// グリッド描画 (thick)
-static inline void draw_grid_thick(HDC hdc, const RECT& vb, const RECT& vp)
+// 画像とグリッドのレイヤーの更新．returns the DC holding the result.
+static inline HDC compose_scene(const RECT& rc, const RECT& vb, const RECT& vp, int mip_level, bool upscale, uint8_t grid_thick)
 {
-	int w = vb.right - vb.left, W = vp.right - vp.left,
-		h = vb.bottom - vb.top, H = vp.bottom - vp.top;
-
-	auto dc_brush = static_cast<HBRUSH>(::GetStockObject(DC_BRUSH));
-	constexpr Color col0 = 0x222222, col1 = 0x444444, col2 = 0x666666,
-		col3 = col2.negate(), col4 = col1.negate(), col5 = col0.negate();
-
-	RECT rch = vp, rcv = vp;
-	auto hline = [&, hdc, dc_brush](int y) { rch.top = y; rch.bottom = y + 1; ::FillRect(hdc, &rch, dc_brush); };
-	auto vline = [&, hdc, dc_brush](int x) { rcv.left = x; rcv.right = x + 1; ::FillRect(hdc, &rcv, dc_brush); };
-
-	// least significant lines.
-	::SetDCBrushColor(hdc, col3);
-	for (int x = vb.left; x < vb.right; x++) {
-		if (x % 5 != 0) vline((x - vb.left) * W / w + vp.left);
-	}
-	for (int y = vb.top; y < vb.bottom; y++) {
-		if (y % 5 != 0) hline((y - vb.top) * H / h + vp.top);
-	}
-	::SetDCBrushColor(hdc, col2);
-	for (int x = vb.left + 1; x <= vb.right; x++) {
-		if (x % 5 != 0) vline((x - vb.left) * W / w + vp.left - 1);
-	}
-	for (int y = vb.top + 1; y <= vb.bottom; y++) {
-		if (y % 5 != 0) hline((y - vb.top) * H / h + vp.top - 1);
-	}
-
-	// multiple of 5, but not 10.
-	::SetDCBrushColor(hdc, col4);
-	for (int x = vb.left + 9 - ((vb.left + 4) % 10); x < vb.right; x += 10)
-		vline((x - vb.left) * W / w + vp.left);
-	for (int y = vb.top + 9 - ((vb.top + 4) % 10); y < vb.bottom; y += 10)
-		hline((y - vb.top) * H / h + vp.top);
-	::SetDCBrushColor(hdc, col1);
-	for (int x = vb.left + 10 - ((vb.left + 5) % 10); x <= vb.right; x += 10)
-		vline((x - vb.left) * W / w + vp.left - 1);
-	for (int y = vb.top + 10 - ((vb.top + 5) % 10); y <= vb.bottom; y += 10)
-		hline((y - vb.top) * H / h + vp.top - 1);
-
-	// multiple of 10.
-	::SetDCBrushColor(hdc, col5);
-	for (int x = vb.left + 9 - ((vb.left + 9) % 10); x < vb.right; x += 10)
-		vline((x - vb.left) * W / w + vp.left);
-	for (int y = vb.top + 9 - ((vb.top + 9) % 10); y < vb.bottom; y += 10)
-		hline((y - vb.top) * H / h + vp.top);
-	::SetDCBrushColor(hdc, col0);
-	for (int x = vb.left + 10 - (vb.left % 10); x <= vb.right; x += 10)
-		vline((x - vb.left) * W / w + vp.left - 1);
-	for (int y = vb.top + 10 - (vb.top % 10); y <= vb.bottom; y += 10)
-		hline((y - vb.top) * H / h + vp.top - 1);
+	auto const& picture = compose_picture(rc, vb, vp, mip_level, upscale);
+	if (grid_thick == 0) return picture.surface.hdc();
+
+	auto& layer = compositor.scene;
+	bool const kept = !layer.surface.resize(rc.right, rc.bottom) && layer.valid;
+	if (kept && layer.picture_epoch == picture.epoch && layer.grid_thick == grid_thick) {
+		layer.hits++;
+		return layer.surface.hdc();
+	}
+	layer.misses++; layer.epoch++;
+
+	::BitBlt(layer.surface.hdc(), 0, 0, rc.right, rc.bottom, picture.surface.hdc(), 0, 0, SRCCOPY);
+	draw_grid(layer.surface.hdc(), &layer.surface, vb, vp, grid_thick);
+
+	layer.picture_epoch = picture.epoch;
+	layer.grid_thick = grid_thick;
+	layer.valid = true;
+	return layer.surface.hdc();
 }
 
 // 背景グラデーション & 枠付きの丸角矩形を描画．
 static inline void draw_round_rect(HDC hdc, const RECT& rc, int corner, int thick, Color back_top, Color back_btm, Color chrome)
 {
+	if (ImageView dib; settings.performance.chrome_cache && dib_view_of(hdc, dib)) {
+		// copy the pre-rendered one onto the pixels.
+		::GdiFlush();
+		if (chrome_sprites.draw(dib, rc.left, rc.top, {
+			.width = rc.right - rc.left, .height = rc.bottom - rc.top, .corner = corner, .thick = thick,
+			.back_top = static_cast<uint32_t>(back_top.raw), .back_bottom = static_cast<uint32_t>(back_btm.raw),
+			.chrome = static_cast<uint32_t>(chrome.raw) })) return;
+	}
+
 	auto br = ::SelectObject(hdc, ::GetStockObject(DC_BRUSH)),
 		pen = ::SelectObject(hdc, ::GetStockObject(NULL_PEN));
 	if (thick > 0) {
@@ -612,186 +889,258 @@ static inline void draw_round_rect(HDC hdc, const RECT& rc, int corner, int thic
 	}
 	::SelectObject(hdc, br); ::SelectObject(hdc, pen);
 }
-// 色・座標表示ボックス描画．
-static inline void draw_tip(HDC hdc, const SIZE& canvas, const RECT& box,
-	Color pixel_color, const POINT& pix, const SIZE& screen, bool& prefer_above,
-	HFONT font, const Settings::TipDrag& tip_drag, const Settings::ColorScheme& color_scheme)
+// rasterizes the printable ASCII glyphs of `font` into `atlas` unless done yet.
+// returns false if the atlas isn't available.
+static inline bool prepare_glyphs(GlyphAtlas& atlas, HFONT font)
+{
+	if (atlas.is_valid()) return true;
+
+	// measure the glyphs.
+	TEXTMETRICW tm;
+	ABC abc[GlyphAtlas::num_glyphs];
+	{
+		HDC const dc = ::CreateCompatibleDC(nullptr);
+		auto const tmp_fon = ::SelectObject(dc, font);
+		bool const measured = ::GetTextMetricsW(dc, &tm) != FALSE &&
+			::GetCharABCWidthsW(dc, GlyphAtlas::first_char, GlyphAtlas::last_char, abc) != FALSE;
+		::SelectObject(dc, tmp_fon);
+		::DeleteDC(dc);
+		if (!measured) return false;
+	}
+
+	// leave a pixel on each side for the antialiasing.
+	GlyphAtlas::Glyph layout[GlyphAtlas::num_glyphs];
+	for (int i = 0; i < GlyphAtlas::num_glyphs; i++) {
+		layout[i] = {
+			.left = abc[i].abcA - 1, .width = static_cast<int32_t>(abc[i].abcB) + 2,
+			.advance = abc[i].abcA + static_cast<int32_t>(abc[i].abcB) + abc[i].abcC,
+		};
+	}
+	int const width = GlyphAtlas::layout(layout);
+
+	// draw them in white on black.
+	DIBSurface strip{};
+	strip.resize(width, tm.tmHeight);
+	if (!strip.is_valid()) return false;
+	HDC const hdc = strip.hdc();
+	auto const tmp_fon = ::SelectObject(hdc, font);
+	::PatBlt(hdc, 0, 0, width, tm.tmHeight, BLACKNESS);
+	::SetTextColor(hdc, RGB(255, 255, 255));
+	::SetBkMode(hdc, TRANSPARENT);
+	for (int i = 0; i < GlyphAtlas::num_glyphs; i++) {
+		wchar_t const c = static_cast<wchar_t>(GlyphAtlas::first_char + i);
+		::TextOutW(hdc, layout[i].x - layout[i].left, 0, &c, 1);
+	}
+	::SelectObject(hdc, tmp_fon);
+	::GdiFlush();
+
+	return atlas.build(layout, tm.tmHeight, strip.view());
+}
+
+// the atlas to draw the text with if enabled and covers the text, or nullptr.
+static inline GlyphAtlas* glyphs_for(GlyphAtlas* atlas, HFONT font, const wchar_t* str, int len)
+{
+	if (atlas == nullptr || !settings.performance.glyph_atlas ||
+		!prepare_glyphs(*atlas, font) || !atlas->covers(str, len)) return nullptr;
+	return atlas;
+}
+
+// 色・座標表示ボックス描画．returns the bounding rect of the drawn area.
+static inline RECT draw_tip(HDC hdc, const SIZE& canvas, const RECT& box,
+	Color pixel_color, const RegionStats::Stats& stats, const POINT& pix, const SIZE& screen, bool& prefer_above,
+	HFONT font, GlyphAtlas* atlas, const Settings::TipDrag& tip_drag, const Settings::ColorScheme& color_scheme)
 {
 	RECT box_big = box;
 	box_big.left -= tip_drag.box_inflate; box_big.right += tip_drag.box_inflate;
 	box_big.top -= tip_drag.box_inflate; box_big.bottom += tip_drag.box_inflate;
 
 	// draw the "pixel box".
-	::SetDCBrushColor(hdc, pixel_color);
-	::FillRect(hdc, &box_big, static_cast<HBRUSH>(::GetStockObject(DC_BRUSH)));
-	::FrameRect(hdc, &box_big, static_cast<HBRUSH>(::GetStockObject(
-		pixel_color.luma() <= Color::max_luma / 2 ? WHITE_BRUSH : BLACK_BRUSH)));
+	draw_on(hdc, [&](Canvas& canvas) {
+		overlay::draw_pixel_box(canvas, std::bit_cast<Rect>(box_big), pixel_color,
+			pixel_color.luma() <= Color::max_luma / 2 ? RGB(255, 255, 255) : RGB(0, 0, 0));
+	});
 
 	// prepare text.
 
 	// prepare the string to place in.
 	wchar_t tip_str[std::bit_ceil(
-		std::max(std::size(L"#RRGGBB"), std::size(L"RGB(000,000,000)")) + 1 +
+		std::max(std::size(L"#RRGGBB"), 3 * std::size(L"avg RGB(000,000,000)") + std::size(L"sd  (000.0,000.0,000.0)")) + 1 +
 		std::max(std::size(L"X:1234, Y:1234"), std::size(L"X:-1234.5, Y:-1234.5")))];
+	// this runs on every mouse move, so avoid the printf family.
+	using namespace sigma_lib::format;
 	int tip_strlen = 0;
+	auto const put_rgb = [&](const wchar_t* label, const byte(&bgr)[3]) {
+		// "%sRGB(%3u,%3u,%3u)\n".
+		tip_strlen += put(tip_str + tip_strlen, label);
+		tip_strlen += put(tip_str + tip_strlen, L"RGB(");
+		tip_strlen += put_int(tip_str + tip_strlen, bgr[2], 3);
+		tip_str[tip_strlen++] = L',';
+		tip_strlen += put_int(tip_str + tip_strlen, bgr[1], 3);
+		tip_str[tip_strlen++] = L',';
+		tip_strlen += put_int(tip_str + tip_strlen, bgr[0], 3);
+		tip_strlen += put(tip_str + tip_strlen, L")\n");
+	};
 	switch (tip_drag.color_fmt) {
 		using enum Settings::ColorFormat;
-	case dec3x3:
-		tip_strlen += std::swprintf(tip_str, std::size(tip_str),
-			L"RGB(%3u,%3u,%3u)\n", pixel_color.R, pixel_color.G, pixel_color.B);
+	case mean_hexdec6:
+		// "#%06X\n" of the average.
+		tip_str[tip_strlen++] = L'#';
+		tip_strlen += put_hex6(tip_str + tip_strlen,
+			Color{ stats.mean[2], stats.mean[1], stats.mean[0] }.to_formattable(), true);
+		tip_str[tip_strlen++] = L'\n';
 		break;
-	case hexdec6:
-	default:
-		tip_strlen += std::swprintf(tip_str, std::size(tip_str),
-			L"#%06X\n", pixel_color.to_formattable());
+	case stats_dec3x3:
+		put_rgb(L"avg ", stats.mean);
+		put_rgb(L"min ", stats.min);
+		put_rgb(L"max ", stats.max);
+		// "sd  (%5.1f,%5.1f,%5.1f)\n".
+		tip_strlen += put(tip_str + tip_strlen, L"sd  (");
+		tip_strlen += put_tenths(tip_str + tip_strlen, stats.deviation10[2], 5);
+		tip_str[tip_strlen++] = L',';
+		tip_strlen += put_tenths(tip_str + tip_strlen, stats.deviation10[1], 5);
+		tip_str[tip_strlen++] = L',';
+		tip_strlen += put_tenths(tip_str + tip_strlen, stats.deviation10[0], 5);
+		tip_strlen += put(tip_str + tip_strlen, L")\n");
 		break;
-	}
-	switch (tip_drag.coord_fmt) {
-		using enum Settings::CoordFormat;
-	case origin_center:
-	{
-		constexpr auto len_prec = [](int scr) -> std::pair<int, int> {
-			// no half-integer when (scr & 1) == 0.
-			// at most 3 digits (plus sign) when scr < 2000. 4 digits is rarely necessary.
-			return { 1 + (scr < 2000 ? 3 : 4) + (2 * (scr & 1)), scr & 1 };
-		};
-		auto [x_l, x_p] = len_prec(screen.cx);
-		auto [y_l, y_p] = len_prec(screen.cy);
-		tip_strlen += std::swprintf(&tip_str[tip_strlen], std::size(tip_str) - tip_strlen,
-			L"X:%*.*f, Y:%*.*f", x_l, x_p, pix.x - screen.cx / 2.0, y_l, y_p, pix.y - screen.cy / 2.0);
+	case dec3x3:
+		// "RGB(%3u,%3u,%3u)\n".
+		tip_strlen += put(tip_str + tip_strlen, L"RGB(");
+		tip_strlen += put_int(tip_str + tip_strlen, pixel_color.R, 3);
+		tip_str[tip_strlen++] = L',';
+		tip_strlen += put_int(tip_str + tip_strlen, pixel_color.G, 3);
+		tip_str[tip_strlen++] = L',';
+		tip_strlen += put_int(tip_str + tip_strlen, pixel_color.B, 3);
+		tip_strlen += put(tip_str + tip_strlen, L")\n");
 		break;
-	}
-	case origin_top_left:
+	case hsv: case hls: case ycbcr601: case ycbcr709: case lab: case lch:
+		tip_strlen += put_color_space(tip_str + tip_strlen, tip_drag.color_fmt, pixel_color, true);
+		tip_str[tip_strlen++] = L'\n';
+		break;
+	case hexdec6:
 	default:
-		tip_strlen += std::swprintf(&tip_str[tip_strlen], std::size(tip_str) - tip_strlen,
-			L"X:%4d, Y:%4d", pix.x, pix.y);
+		// "#%06X\n".
+		tip_str[tip_strlen++] = L'#';
+		tip_strlen += put_hex6(tip_str + tip_strlen, pixel_color.to_formattable(), true);
+		tip_str[tip_strlen++] = L'\n';
 		break;
 	}
+	tip_strlen += overlay::put_coord(tip_str + tip_strlen, pix.x, pix.y, screen.cx, screen.cy,
+		tip_drag.coord_fmt == Settings::CoordFormat::origin_center);
+	tip_str[tip_strlen] = L'\0';
 
 	// measure the text size.
 	auto tmp_fon = ::SelectObject(hdc, font);
 	RECT rc_txt{}, rc_frm;
-	::DrawTextW(hdc, tip_str, tip_strlen, &rc_txt, DT_CENTER | DT_TOP | DT_NOPREFIX | DT_NOCLIP | DT_CALCRECT);
-	{
-		const int w = rc_txt.right - rc_txt.left, h = rc_txt.bottom - rc_txt.top,
-			x_min = tip_drag.chrome_margin_h + tip_drag.chrome_pad_h,
-			x_max = canvas.cx - (w + tip_drag.chrome_pad_h + tip_drag.chrome_margin_h),
-			y_min = tip_drag.chrome_margin_v + tip_drag.chrome_pad_v,
-			y_max = canvas.cy - (h + tip_drag.chrome_pad_v + tip_drag.chrome_margin_v);
-
-		int x = (box.left + box.right) / 2 - w / 2;
-
-		// choose whether the tip should be placed above or below the box.
-		const int yU = box.top - tip_drag.box_tip_gap - tip_drag.chrome_pad_v - h,
-			yD = box.bottom + tip_drag.box_tip_gap + tip_drag.chrome_pad_v;
-		if (auto up = y_min <= yU, dn = yD <= y_max; up || dn)
-			prefer_above = prefer_above ? up : !dn;
-		int y = prefer_above ? yU : yD;
-
-		constexpr auto adjust = [](auto v, auto m, auto M) { return m > M ? (m + M) / 2 : std::clamp(v, m, M); };
-		x = adjust(x, x_min, x_max);
-		y = adjust(y, y_min, y_max);
-
-		rc_txt = { x, y, x + w, y + h };
-		rc_frm = {
-			rc_txt.left  - tip_drag.chrome_pad_h, rc_txt.top    - tip_drag.chrome_pad_v,
-			rc_txt.right + tip_drag.chrome_pad_h, rc_txt.bottom + tip_drag.chrome_pad_v
-		};
-	}
+	ImageView dib;
+	auto const glyphs = dib_view_of(hdc, dib) ? glyphs_for(atlas, font, tip_str, tip_strlen) : nullptr;
+	if (glyphs != nullptr) {
+		auto [w, h] = glyphs->measure(tip_str, tip_strlen);
+		rc_txt.right = w; rc_txt.bottom = h;
+	}
+	else ::DrawTextW(hdc, tip_str, tip_strlen, &rc_txt, DT_CENTER | DT_TOP | DT_NOPREFIX | DT_NOCLIP | DT_CALCRECT);
+	auto const layout = overlay::place_tip(std::bit_cast<Rect>(box),
+		rc_txt.right - rc_txt.left, rc_txt.bottom - rc_txt.top, canvas.cx, canvas.cy, tip_drag.box_tip_gap,
+		{ tip_drag.chrome_margin_h, tip_drag.chrome_margin_v, tip_drag.chrome_pad_h, tip_drag.chrome_pad_v },
+		prefer_above);
+	rc_txt = std::bit_cast<RECT>(layout.text);
+	rc_frm = std::bit_cast<RECT>(layout.frame);
 
 	// draw the round rect and its frame.
 	draw_round_rect(hdc, rc_frm, tip_drag.chrome_corner, tip_drag.chrome_thick,
 		color_scheme.back_top, color_scheme.back_bottom, color_scheme.chrome);
 
 	// then draw the text.
-	::SetTextColor(hdc, color_scheme.text);
-	::SetBkMode(hdc, TRANSPARENT);
-	::DrawTextW(hdc, tip_str, tip_strlen, &rc_txt, DT_CENTER | DT_TOP | DT_NOPREFIX | DT_NOCLIP);
+	if (glyphs != nullptr) {
+		::GdiFlush();
+		glyphs->draw(dib, rc_txt.left, rc_txt.top, rc_txt.right - rc_txt.left, true,
+			tip_str, tip_strlen, static_cast<uint32_t>(color_scheme.text.raw));
+	}
+	else {
+		::SetTextColor(hdc, color_scheme.text);
+		::SetBkMode(hdc, TRANSPARENT);
+		::DrawTextW(hdc, tip_str, tip_strlen, &rc_txt, DT_CENTER | DT_TOP | DT_NOPREFIX | DT_NOCLIP);
+	}
 	::SelectObject(hdc, tmp_fon);
+
+	return std::bit_cast<RECT>(layout.bounds(tip_drag.chrome_thick) | std::bit_cast<Rect>(box_big));
 }
-// 通知メッセージトースト描画．
-static inline void draw_toast(HDC hdc, const SIZE& canvas, const wchar_t* message,
-	HFONT font, const Settings::Toast& toast, const Settings::ColorScheme& color_scheme)
+// 通知メッセージトースト描画．returns the bounding rect of the drawn area.
+static inline RECT draw_toast(HDC hdc, const SIZE& canvas, const wchar_t* message,
+	HFONT font, GlyphAtlas* atlas, const Settings::Toast& toast, const Settings::ColorScheme& color_scheme)
 {
 	_ASSERT(ext_obj.is_active());
 
 	// measure the text size.
 	auto tmp_fon = ::SelectObject(hdc, font);
 	RECT rc_txt{}, rc_frm{};
-	::DrawTextW(hdc, message, -1, &rc_txt, DT_NOPREFIX | DT_NOCLIP | DT_CALCRECT);
-
-	// align horizontally.
-	auto l = rc_txt.right - rc_txt.left;
-	switch (toast.placement) {
-		using enum Settings::Toast::Placement;
-	case top_left:
-	case left:
-	case bottom_left:
-		rc_frm.left = toast.chrome_margin_h;
-		goto from_left;
-	case top_right:
-	case right:
-	case bottom_right:
-		rc_frm.right = canvas.cx - toast.chrome_margin_h;
-		rc_txt.right = rc_frm.right - toast.chrome_pad_h;
-		rc_txt.left = rc_txt.right - l;
-		rc_frm.left = rc_txt.left - toast.chrome_pad_h;
-		break;
-	default:
-		rc_frm.left = canvas.cx / 2 - l / 2 - toast.chrome_pad_h;
-	from_left:
-		rc_txt.left = rc_frm.left + toast.chrome_pad_h;
-		rc_txt.right = rc_txt.left + l;
-		rc_frm.right = rc_txt.right + toast.chrome_pad_h;
-		break;
-	}
-
-	// then vertically.
-	l = rc_txt.bottom - rc_txt.top;
-	switch (toast.placement) {
-		using enum Settings::Toast::Placement;
-	case top_left:
-	case top:
-	case top_right:
-		rc_frm.top = toast.chrome_margin_v;
-		goto from_top;
-	case bottom_left:
-	case bottom:
-	case bottom_right:
-		rc_frm.bottom = canvas.cy - toast.chrome_margin_v;
-		rc_txt.bottom = rc_frm.bottom - toast.chrome_pad_v;
-		rc_txt.top = rc_txt.bottom - l;
-		rc_frm.top = rc_txt.top - toast.chrome_pad_v;
-		break;
-	default:
-		rc_frm.top = canvas.cy / 2 - l / 2 - toast.chrome_pad_v;
-	from_top:
-		rc_txt.top = rc_frm.top + toast.chrome_pad_v;
-		rc_txt.bottom = rc_txt.top + l;
-		rc_frm.bottom = rc_txt.bottom + toast.chrome_pad_v;
-		break;
-	}
+	ImageView dib;
+	int const len = static_cast<int>(std::wcslen(message));
+	auto const glyphs = dib_view_of(hdc, dib) ? glyphs_for(atlas, font, message, len) : nullptr;
+	if (glyphs != nullptr) {
+		auto [w, h] = glyphs->measure(message, len);
+		rc_txt.right = w; rc_txt.bottom = h;
+	}
+	else ::DrawTextW(hdc, message, -1, &rc_txt, DT_NOPREFIX | DT_NOCLIP | DT_CALCRECT);
+
+	// the placement is numbered from the top-left to the bottom-right, row by row.
+	auto const placement = static_cast<int>(toast.placement);
+	auto const layout = overlay::place_toast(rc_txt.right - rc_txt.left, rc_txt.bottom - rc_txt.top,
+		canvas.cx, canvas.cy, placement % 3 - 1, placement / 3 - 1,
+		{ toast.chrome_margin_h, toast.chrome_margin_v, toast.chrome_pad_h, toast.chrome_pad_v });
+	rc_txt = std::bit_cast<RECT>(layout.text);
+	rc_frm = std::bit_cast<RECT>(layout.frame);
 
 	// draw the round rect and its frame.
 	draw_round_rect(hdc, rc_frm, toast.chrome_corner, toast.chrome_thick,
 		color_scheme.back_top, color_scheme.back_bottom, color_scheme.chrome);
 
 	// then draw the text.
-	::SetTextColor(hdc, color_scheme.text);
-	::SetBkMode(hdc, TRANSPARENT);
-	::DrawTextW(hdc, message, -1, &rc_txt, DT_NOPREFIX | DT_NOCLIP);
+	if (glyphs != nullptr) {
+		::GdiFlush();
+		glyphs->draw(dib, rc_txt.left, rc_txt.top, rc_txt.right - rc_txt.left, false,
+			message, len, static_cast<uint32_t>(color_scheme.text.raw));
+	}
+	else {
+		::SetTextColor(hdc, color_scheme.text);
+		::SetBkMode(hdc, TRANSPARENT);
+		::DrawTextW(hdc, message, -1, &rc_txt, DT_NOPREFIX | DT_NOCLIP);
+	}
 	::SelectObject(hdc, tmp_fon);
+
+	return std::bit_cast<RECT>(layout.bounds(toast.chrome_thick));
+}
+
+// ヒストグラム描画．returns the drawn area.
+static inline RECT draw_histogram(HDC hdc, const SIZE& canvas)
+{
+	// placed at the bottom-left corner.
+	constexpr int margin = 4, width = 256, height = 64;
+	ImageView dib;
+	if (!dib_view_of(hdc, dib)) return {};
+	RECT const rc = {
+		margin, canvas.cy - margin - std::min(height, canvas.cy - 2 * margin),
+		margin + std::min(width, canvas.cx - 2 * margin), canvas.cy - margin,
+	};
+	if (rc.left >= rc.right || rc.top >= rc.bottom) return {};
+
+	::GdiFlush();
+	histogram.draw(dib, std::bit_cast<Rect>(rc));
+	return rc;
 }
 
 // 未編集時などの無効状態で単色背景を描画 (+通知メッセージも)．
 static inline void draw_blank(HWND hwnd)
 {
+	// the next frame should be drawn regardless of its changes.
+	image.invalidate();
+	compositor.invalidate();
+
 	auto toast_visible = ext_obj.is_active() && loupe_state.toast.visible;
-	BufferedDC bf{ hwnd, toast_visible };
+	BufferedDC bf{ hwnd, back_buffer, BufferedDC::client_size(hwnd), toast_visible };
 
-	draw_backplane(bf.hdc(), bf.rc());
+	draw_on(bf.hdc(), [&](Canvas& canvas) { draw_backplane(canvas, bf.rc()); });
 	if (toast_visible) draw_toast(bf.hdc(), bf.sz(),
-		loupe_state.toast.message, toast_font, settings.toast, settings.color);
+		loupe_state.toast.message, toast_font, &toast_glyphs, settings.toast, settings.color);
 }
 
 // メインの描画関数．
@@ -799,6 +1148,7 @@ static inline void draw(HWND hwnd)
 {
 	// image.is_valid() must be true here.
 	_ASSERT(image.is_valid());
+	idle_trimmer.postpone(hwnd);
 
 	// firstly, collect information before drawing.
 	auto [wd, ht] = BufferedDC::client_size(hwnd);
@@ -818,47 +1168,202 @@ static inline void draw(HWND hwnd)
 	bool with_tip = tip.is_visible() &&
 		tip.x >= 0 && tip.x < image.width() && tip.y >= 0 && tip.y < image.height();
 
-	// now collected information to know whether double-buffering should help.
-	// in most cases, whole window is covered by a single image and needs not wrapping.
-	BufferedDC bf{ hwnd, wd, ht, is_partial || grid_thick > 0 || with_tip || loupe_state.toast.visible };
+	// choose the level of the mipmap when zoomed out.
+	int mip_level = 0;
+	if (settings.performance.mipmap && loupe_state.zoom.zoom_level < 0 &&
+		!loupe_state.difference.visible && !loupe_state.lut.visible) {
+		auto [n, d] = loupe_state.zoom.scale_ratio_Q();
+		mip_level = MipPyramid::level_for(n, d);
+	}
 
-	// now ready for drawing...
-	// some part of the window is exposed. fill the background.
-	if (is_partial) draw_backplane(bf.hdc(), bf.rc());
+	// make sure the pixels to draw are loaded.
+	bool const tip_stats = with_tip && uses_region_stats(settings.tip_drag.color_fmt);
+	{
+		auto area = std::bit_cast<Rect>(vb);
+		if (mip_level > 0) area = MipPyramid::aligned_area(area, image.width(), image.height());
+		if (tip_stats) area |= tip_region().inflate(RegionStats::margin, RegionStats::margin);
+		else if (with_tip) area |= tip_region();
+		if (!image.ensure(area, settings.performance.ingest_margin, frame_source)) {
+			// the frame is no longer available; the private copy would show stale pixels.
+			draw_blank(hwnd);
+			return;
+		}
+	}
+	if (mip_level > 0)
+		mipmap.prepare(static_cast<const byte*>(image.buffer()), image.width(), image.height(), std::bit_cast<Rect>(vb));
+	auto const stats = tip_stats ? region_stats.query(image_view(), tip_region()) : RegionStats::Stats{};
 
-	// draw the main image.
-	draw_picture(bf.hdc(), vb, vp);
+	// compare the view with the previous frame.
+	if (loupe_state.difference.visible) {
+		frame_diff.capture(image_view(), std::bit_cast<Rect>(vb), image.current_rect());
+		frame_diff.render(std::bit_cast<Rect>(vb));
+	}
 
-	// draw the grid.
-	if (grid_thick == 1) draw_grid_thin(bf.hdc(), vb, vp);
-	else if (grid_thick >= 2) draw_grid_thick(bf.hdc(), vb, vp);
+	// convert the pixels in the view through the LUT, unless the differences are shown instead.
+	if (loupe_state.lut.visible && !loupe_state.difference.visible)
+		lut.render(image_view(), std::bit_cast<Rect>(vb));
+	Color const tip_color = with_tip ?
+		view_color(image.color_at(tip.x, tip.y), settings.lut.tip_transformed) : Color{};
 
-	// draw the info tip.
+	// count the colors in the view. the last counts are reused unless the pixels are gone.
+	bool const with_histogram = loupe_state.histogram.visible;
+	if (with_histogram) {
+		histogram.invalidate(Rect::empty(), image.current_rect());
+		histogram.update(image_view(), std::bit_cast<Rect>(vb), strips());
+	}
+
+	// the box of the tip on the screen.
+	RECT tip_box{};
 	if (with_tip) {
 		auto [x, y] = loupe_state.pic2win(tip.x, tip.y);
-		x += bf.wd() / 2.0; y += bf.ht() / 2.0;
+		x += wd / 2.0; y += ht / 2.0;
 		auto s = loupe_state.zoom.scale_ratio();
-		draw_tip(bf.hdc(), bf.sz(), {
+		tip_box = {
 			static_cast<int>(std::floor(x)), static_cast<int>(std::floor(y)),
 			static_cast<int>(std::ceil(x + s)), static_cast<int>(std::ceil(y + s))
-			}, image.color_at(tip.x, tip.y), { tip.x, tip.y }, { image.width(), image.height() },
-			tip.prefer_above, tip_font, settings.tip_drag, settings.color);
+		};
+	}
+
+	// now collected information to know whether double-buffering should help.
+	// in most cases, whole window is covered by a single image and needs not wrapping.
+	bool const layered = settings.performance.layer_cache;
+	back_buffer.begin_frame();
+	BufferedDC bf{ hwnd, back_buffer, wd, ht,
+		layered || is_partial || grid_thick > 0 || with_histogram || with_tip || loupe_state.toast.visible };
+
+	// now ready for drawing...
+	bool const upscale = settings.performance.upscaler && loupe_state.zoom.zoom_level > 0;
+	bool damage_only = false;
+	if (layered) {
+		// the back buffer holds the last frame unless reallocated.
+		auto& overlay = compositor.overlay;
+		if (!bf.is_wrapped() || back_buffer.stats().frame_allocs > 0) overlay.valid = false;
+
+		HDC const scene = compose_scene(bf.rc(), vb, vp, mip_level, upscale, grid_thick);
+		decltype(overlay.key) key{
+			.picture_epoch = compositor.picture.epoch, .scene_epoch = compositor.scene.epoch,
+			.grid_thick = grid_thick,
+			.tip = with_tip, .prefer_above = with_tip && tip.prefer_above, .toast = loupe_state.toast.visible,
+		};
+		if (with_tip) {
+			key.tip_box = std::bit_cast<Rect>(tip_box);
+			key.tip_x = tip.x; key.tip_y = tip.y;
+			key.tip_color = tip_color;
+			key.tip_stats = stats;
+		}
+		if (with_histogram) {
+			key.histogram = true;
+			key.histogram_epoch = histogram.epoch();
+		}
+		if (key.toast) std::memcpy(key.message, loupe_state.toast.message, sizeof(key.message));
+
+		if (overlay.valid && overlay.key == key) {
+			// nothing has changed; just present the back buffer again.
+			overlay.hits++;
+			return;
+		}
+		overlay.misses++;
+
+		if (overlay.valid && overlay.key.picture_epoch == key.picture_epoch &&
+			overlay.key.scene_epoch == key.scene_epoch && overlay.key.grid_thick == key.grid_thick) {
+			// only the overlays have changed. erase them and present only the damaged areas.
+			damage_only = true;
+			for (auto const* rc : { &overlay.histogram_rc, &overlay.tip_rc, &overlay.toast_rc }) {
+				if (::IsRectEmpty(rc)) continue;
+				::BitBlt(bf.hdc(), rc->left, rc->top, rc->right - rc->left, rc->bottom - rc->top,
+					scene, rc->left, rc->top, SRCCOPY);
+				bf.add_damage(*rc);
+			}
+		}
+		else ::BitBlt(bf.hdc(), 0, 0, wd, ht, scene, 0, 0, SRCCOPY);
+
+		overlay.key = key;
+		overlay.histogram_rc = overlay.tip_rc = overlay.toast_rc = {};
+		overlay.valid = true;
+	}
+	else {
+		if (settings.performance.scroll_reuse && mip_level == 0) {
+			// draw through the picture layer to reuse it when scrolled.
+			auto const& picture = compose_picture(bf.rc(), vb, vp, mip_level, upscale);
+			::BitBlt(bf.hdc(), 0, 0, wd, ht, picture.surface.hdc(), 0, 0, SRCCOPY);
+		}
+		else {
+			draw_on(bf.hdc(), [&](Canvas& canvas) {
+				// some part of the window is exposed. fill the background.
+				if (is_partial) draw_backplane(canvas, bf.rc());
+
+				// draw the main image.
+				if (upscale) draw_picture_upscaled(canvas, bf.rc(), vb, vp);
+				else draw_picture(canvas, vb, vp, mip_level);
+			});
+		}
+
+		// draw the grid.
+		draw_grid(bf.hdc(), bf.is_wrapped() ? &back_buffer : nullptr, vb, vp, grid_thick);
+	}
+
+	// draw the histogram.
+	if (with_histogram) {
+		auto rc = draw_histogram(bf.hdc(), bf.sz());
+		if (layered) {
+			compositor.overlay.histogram_rc = rc;
+			if (damage_only) bf.add_damage(rc);
+		}
+	}
+
+	// draw the info tip.
+	if (with_tip) {
+		auto rc = draw_tip(bf.hdc(), bf.sz(), tip_box,
+			tip_color, stats, { tip.x, tip.y }, { image.width(), image.height() },
+			tip.prefer_above, tip_font, &tip_glyphs, settings.tip_drag, settings.color);
+		if (layered) {
+			// the placement might have been flipped, which is the state for the next time.
+			compositor.overlay.key.prefer_above = tip.prefer_above;
+			compositor.overlay.tip_rc = rc;
+			if (damage_only) bf.add_damage(rc);
+		}
 	}
 
 	// draw the toast.
-	if (loupe_state.toast.visible) draw_toast(bf.hdc(), bf.sz(),
-		loupe_state.toast.message, toast_font, settings.toast, settings.color);
+	if (loupe_state.toast.visible) {
+		auto rc = draw_toast(bf.hdc(), bf.sz(),
+			loupe_state.toast.message, toast_font, &toast_glyphs, settings.toast, settings.color);
+		if (layered) {
+			compositor.overlay.toast_rc = rc;
+			if (damage_only) bf.add_damage(rc);
+		}
+	}
+}
+
+// 画像のうちルーペに表示される範囲．
+static inline Rect area_on_screen(HWND hwnd)
+{
+	auto [wd, ht] = BufferedDC::client_size(hwnd);
+	auto [vb, vp] = loupe_state.viewbox_viewport(image.width(), image.height(), wd, ht);
+	return std::bit_cast<Rect>(vb);
+}
+
+// 画像の変更箇所がルーペの表示に影響するかどうか．
+static inline bool is_dirty_on_screen(HWND hwnd, const Rect& dirty)
+{
+	if (dirty.is_empty()) return false;
+	if (dirty.intersects(area_on_screen(hwnd))) return true;
+
+	// the tip shows the color of the pixel even when it's out of the view.
+	return loupe_state.tip.is_visible() && dirty.intersects(tip_region());
 }
 
 // export two functions.
 void dialogs::ExtFunc::DrawTip(HDC hdc, const SIZE& canvas, const RECT& box,
 	Color pixel_color, const POINT& pix, const SIZE& screen, bool& prefer_above,
 	HFONT font, const Settings::TipDrag& tip_drag, const Settings::ColorScheme& color_scheme){
-	draw_tip(hdc, canvas, box, pixel_color, pix, screen, prefer_above, font, tip_drag, color_scheme);
+	// a single pixel stands for the region in the sample.
+	auto const stats = RegionStats::Stats::of_pixel(pixel_color.B, pixel_color.G, pixel_color.R);
+	draw_tip(hdc, canvas, box, pixel_color, stats, pix, screen, prefer_above, font, nullptr, tip_drag, color_scheme);
 }
 void dialogs::ExtFunc::DrawToast(HDC hdc, const SIZE& canvas, const wchar_t* message,
 	HFONT font, const Settings::Toast& toast, const Settings::ColorScheme& color_scheme) {
-	draw_toast(hdc, canvas, message, font, toast, color_scheme);
+	draw_toast(hdc, canvas, message, font, nullptr, toast, color_scheme);
 }
 
 
@@ -1302,6 +1807,70 @@ static inline bool toggle_follow_cursor()
 		loupe_state.position.follow_cursor ? IDS_TOAST_FOLLOW_CURSOR_ON : IDS_TOAST_FOLLOW_CURSOR_OFF);
 	return true;
 }
+static inline bool toggle_histogram()
+{
+	loupe_state.histogram.visible ^= true;
+	return true;
+}
+static inline bool toggle_difference()
+{
+	loupe_state.difference.visible ^= true;
+	if (!loupe_state.difference.visible) frame_diff.release();
+
+	// the picture is entirely different.
+	compositor.invalidate();
+	return true;
+}
+// reads the .cube file specified in the settings. returns false on failure.
+static inline bool load_lut()
+{
+	auto const& file = settings.lut.file;
+	if (file[0] == L'\0') return false;
+
+	// relative paths are from the directory of this plugin.
+	wchar_t path[2 * MAX_PATH];
+	size_t dir_len = 0;
+	if (file[0] != L'\\' && file[0] != L'/' && file[1] != L':') {
+		dir_len = ::GetModuleFileNameW(this_dll, path, MAX_PATH);
+		while (dir_len > 0 && path[dir_len - 1] != L'\\') dir_len--;
+	}
+	std::wmemcpy(path + dir_len, file, std::wcslen(file) + 1);
+
+	HANDLE const h = ::CreateFileW(path, GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (h == INVALID_HANDLE_VALUE) return false;
+	LARGE_INTEGER size{};
+	bool success = false;
+	// 65 points of three values would take about 8 MiB at most, so anything far larger is no LUT.
+	if (::GetFileSizeEx(h, &size) && size.QuadPart <= (64 << 20)) {
+		auto const len = static_cast<DWORD>(size.QuadPart);
+		auto const text = std::make_unique_for_overwrite<char[]>(len);
+		DWORD read = 0;
+		success = ::ReadFile(h, text.get(), len, &read, nullptr) && read == len &&
+			lut.load(text.get(), len);
+	}
+	::CloseHandle(h);
+	return success;
+}
+static inline bool toggle_lut()
+{
+	if (!loupe_state.lut.visible) {
+		// read the file every time, so edits to it are reflected.
+		if (!load_lut()) {
+			toast_manager.set_message(settings.toast.duration, IDS_TOAST_LUT_FAILED);
+			return true;
+		}
+		loupe_state.lut.visible = true;
+	}
+	else {
+		loupe_state.lut.visible = false;
+		lut.release();
+	}
+
+	// the picture is entirely different.
+	compositor.invalidate();
+	return true;
+}
 static inline bool toggle_grid()
 {
 	loupe_state.grid.visible ^= true;
@@ -1384,24 +1953,75 @@ static inline bool copy_color_code(double win_ox, double win_oy)
 	if (!image.is_valid()) return false;
 
 	auto [x, y] = loupe_state.win2pic(win_ox, win_oy);
-	auto color = image.color_at(static_cast<int>(std::floor(x)), static_cast<int>(std::floor(y)));
+	int X = static_cast<int>(std::floor(x)), Y = static_cast<int>(std::floor(y));
+	auto const fmt = settings.commands.copy_color_fmt;
+	auto const region = RegionStats::neighborhood(X, Y, uses_region_stats(fmt) ? settings.commands.copy_stats_size : 1);
+	if (!image.ensure(uses_region_stats(fmt) ? region.inflate(RegionStats::margin, RegionStats::margin) : region,
+		settings.performance.ingest_margin, frame_source)) return false;
+	auto const color = view_color(image.color_at(X, Y), settings.lut.copy_transformed);
 	if (color.A != 0) return false;
-
-	wchar_t buf[std::max(std::size(L"rrggbb"), std::size(L"RGB(255,255,255)"))];
-	switch (settings.commands.copy_color_fmt) {
+	auto const stats = uses_region_stats(fmt) ? region_stats.query(image_view(), region) : RegionStats::Stats{};
+
+	using namespace sigma_lib::format;
+	wchar_t buf[std::max(std::size(L"rrggbb"),
+		3 * std::size(L"avg RGB(255,255,255)") + std::size(L"sd (127.5,127.5,127.5)"))];
+	int len = 0, toast_len = -1;
+	auto const put_rgb = [&](const wchar_t* label, const byte(&bgr)[3]) {
+		// "%sRGB(%u,%u,%u)".
+		len += put(buf + len, label);
+		len += put(buf + len, L"RGB(");
+		len += put_int(buf + len, bgr[2]);
+		buf[len++] = L',';
+		len += put_int(buf + len, bgr[1]);
+		buf[len++] = L',';
+		len += put_int(buf + len, bgr[0]);
+		buf[len++] = L')';
+	};
+	switch (fmt) {
 		using enum Settings::ColorFormat;
+	case mean_hexdec6:
+		// "%06x" of the average.
+		len += put_hex6(buf + len, Color{ stats.mean[2], stats.mean[1], stats.mean[0] }.to_formattable(), false);
+		break;
+	case stats_dec3x3:
+		// "avg RGB(%u,%u,%u) min RGB(%u,%u,%u) max RGB(%u,%u,%u) sd (%.1f,%.1f,%.1f)".
+		put_rgb(L"avg ", stats.mean);
+		toast_len = len; // the toast is too short for the rest.
+		put_rgb(L" min ", stats.min);
+		put_rgb(L" max ", stats.max);
+		len += put(buf + len, L" sd (");
+		len += put_tenths(buf + len, stats.deviation10[2]);
+		buf[len++] = L',';
+		len += put_tenths(buf + len, stats.deviation10[1]);
+		buf[len++] = L',';
+		len += put_tenths(buf + len, stats.deviation10[0]);
+		buf[len++] = L')';
+		break;
 	case dec3x3:
-		std::swprintf(buf, std::size(buf), L"RGB(%u,%u,%u)", color.R, color.G, color.B);
+		// "RGB(%u,%u,%u)".
+		len += put(buf + len, L"RGB(");
+		len += put_int(buf + len, color.R);
+		buf[len++] = L',';
+		len += put_int(buf + len, color.G);
+		buf[len++] = L',';
+		len += put_int(buf + len, color.B);
+		buf[len++] = L')';
+		break;
+	case hsv: case hls: case ycbcr601: case ycbcr709: case lab: case lch:
+		len += put_color_space(buf + len, fmt, color, false);
 		break;
 	case hexdec6:
 	default:
-		std::swprintf(buf, std::size(buf), L"%06x", color.to_formattable());
+		// "%06x".
+		len += put_hex6(buf + len, color.to_formattable(), false);
 		break;
 	}
+	buf[len] = L'\0';
 	if (!copy_text(buf)) return false;
 
 	// toast message.
 	if (!settings.toast.notify_clipboard) return false;
+	if (toast_len >= 0) buf[toast_len] = L'\0';
 	toast_manager.set_message(settings.toast.duration, IDS_TOAST_CLIPBOARD, buf);
 	return true;
 }
@@ -1415,22 +2035,31 @@ static inline bool copy_coordinate(double win_ox, double win_oy)
 		w = image.width(), h = image.height();
 	if (!(0 <= img_x && img_x < w && 0 <= img_y && img_y < h)) return false;
 
+	using namespace sigma_lib::format;
 	wchar_t buf[std::max(std::size(L"1234,1234"), std::size(L"-1234.5,-1234.5"))];
+	int len = 0;
 	switch (settings.commands.copy_coord_fmt) {
 		using enum Settings::CoordFormat;
 	case origin_center:
 	{
-		x = img_x - w / 2.0; y = img_y - h / 2.0;
-		if (!(std::abs(x) < 10'000 && std::abs(y) < 10'000)) return false;
-		std::swprintf(buf, std::size(buf), L"%.*f,%.*f", w & 1, x, h & 1, y);
+		// "%.*f,%.*f" of img - size / 2.0.
+		int const x2 = 2 * img_x - w, y2 = 2 * img_y - h;
+		if (!(std::abs(x2) < 20'000 && std::abs(y2) < 20'000)) return false;
+		len += put_half(buf + len, x2);
+		buf[len++] = L',';
+		len += put_half(buf + len, y2);
 		break;
 	}
 	case origin_top_left:
 	default:
+		// "%d,%d".
 		if (!(img_x < 10'000 && img_y < 10'000)) return false;
-		std::swprintf(buf, std::size(buf), L"%d,%d", img_x, img_y);
+		len += put_int(buf + len, img_x);
+		buf[len++] = L',';
+		len += put_int(buf + len, img_y);
 		break;
 	}
+	buf[len] = L'\0';
 	if (!copy_text(buf)) return false;
 
 	// toast message.
@@ -1468,6 +2097,11 @@ static inline bool open_settings(HWND hwnd)
 		// discard font handles for new font settings.
 		tip_font.free();
 		toast_font.free();
+		tip_glyphs.release();
+		toast_glyphs.release();
+
+		// the colors and fonts might have changed.
+		compositor.invalidate();
 		return true;
 	}
 	return false;
@@ -1492,6 +2126,9 @@ struct Menu {
 		ena(IDM_CXT_PT_BRING_CENTER,		by_mouse && image.is_valid());
 		chk(IDM_CXT_FOLLOW_CURSOR,			loupe_state.position.follow_cursor);
 		chk(IDM_CXT_SHOW_GRID,				loupe_state.grid.visible);
+		chk(IDM_CXT_SHOW_HISTOGRAM,			loupe_state.histogram.visible);
+		chk(IDM_CXT_SHOW_DIFFERENCE,		loupe_state.difference.visible);
+		chk(IDM_CXT_SHOW_LUT,				loupe_state.lut.visible);
 		ena(IDM_CXT_SWAP_ZOOM,				image.is_valid());
 		ena(IDM_CXT_CENTRALIZE,				image.is_valid());
 		chk(IDM_CXT_TIP_MODE_FRAIL,			settings.tip_drag.mode == Settings::TipDrag::frail);
@@ -1538,6 +2175,9 @@ struct Menu {
 
 		case IDM_CXT_FOLLOW_CURSOR:	return toggle_follow_cursor();
 		case IDM_CXT_SHOW_GRID:		return toggle_grid();
+		case IDM_CXT_SHOW_HISTOGRAM:	return toggle_histogram();
+		case IDM_CXT_SHOW_DIFFERENCE:	return toggle_difference();
+		case IDM_CXT_SHOW_LUT:		return toggle_lut();
 		case IDM_CXT_SWAP_ZOOM:
 		{
 			double x = 0, y = 0;
@@ -1577,11 +2217,61 @@ struct Menu {
 ////////////////////////////////
 // AviUtlに渡す関数の定義．
 ////////////////////////////////
-static inline void on_update(int w, int h, void* source)
+// returns true if the loupe needs redrawing.
+// `frame` is the number of the frame in the editing, told apart from a re-render of the same frame.
+static inline bool on_update(HWND hwnd, int w, int h, void* source, int frame)
 {
-	if (source != nullptr && image.update(w, h, source))
+	if (source == nullptr) return true;
+
+	bool size_changed;
+	switch (settings.performance.ingest) {
+		using enum Settings::Performance::Ingest;
+	case viewbox:
+	{
+		// take in the area around the view, and the pixels of the tip.
+		int const m = settings.performance.ingest_margin;
+		auto region = area_on_screen(hwnd).inflate(m, m);
+		if (loupe_state.tip.is_visible()) region |= tip_region();
+		size_changed = image.update(w, h, source, region);
+		break;
+	}
+	case borrow:
+		// no copy; every frame is considered changed.
+		size_changed = image.update_borrowed(w, h, source);
+		break;
+	case full:
+	default:
+		size_changed = image.update(w, h, source);
+		break;
+	}
+
+	mipmap.invalidate(image.dirty_rect(), image.cached_rect());
+	region_stats.invalidate(image.dirty_rect(), image.cached_rect());
+	histogram.invalidate(image.dirty_rect(), image.cached_rect());
+	lut.invalidate(image.dirty_rect());
+	compositor.invalidate(image.dirty_rect());
+
+	bool diff_changed = false;
+	if (loupe_state.difference.visible) {
+		// a re-render of the same frame replaces its pixels, still compared with the frame before.
+		// keep the visible part of the frame, even if it isn't drawn before the next one.
+		frame_diff.next_frame(frame);
+		frame_diff.capture(image_view(), area_on_screen(hwnd) & image.current_rect(), image.current_rect());
+
+		// the differences change also where the previous frame changed.
+		compositor.invalidate();
+		diff_changed = true;
+	}
+
+	if (size_changed) {
 		// notify the loupe of resizing.
 		loupe_state.on_resize(w, h);
+		return true;
+	}
+	if (diff_changed) return true;
+
+	// skip drawing if nothing has changed in the view.
+	return is_dirty_on_screen(hwnd, image.dirty_rect());
 }
 static inline void on_command(bool& redraw_loupe, HWND hwnd, Settings::ClickActions::Command cmd, const POINT& pt)
 {
@@ -1615,6 +2305,9 @@ static inline void on_command(bool& redraw_loupe, HWND hwnd, Settings::ClickActi
 	case ca::toggle_follow_cursor:	redraw_loupe |= toggle_follow_cursor();	break;
 	case ca::centralize:			redraw_loupe |= centralize();			break;
 	case ca::toggle_grid:			redraw_loupe |= toggle_grid();			break;
+	case ca::toggle_histogram:		redraw_loupe |= toggle_histogram();		break;
+	case ca::toggle_difference:		redraw_loupe |= toggle_difference();	break;
+	case ca::toggle_lut:			redraw_loupe |= toggle_lut();			break;
 	case ca::zoom_step_down:
 	case ca::zoom_step_up:
 	{
@@ -1646,12 +2339,17 @@ static inline void on_command(bool& redraw_loupe, HWND hwnd, Settings::ClickActi
 
 static BOOL func_proc(FilterPlugin* fp, FilterProcInfo* fpip)
 {
+	frame_source.editp = fpip->editp;
+
 	// updates to the target image.
 	if (ext_obj.is_active() &&
 		fp->exfunc->is_editing(fpip->editp) && !fp->exfunc->is_saving(fpip->editp)) {
 
-		on_update(fpip->w, fpip->h, fp->exfunc->get_disp_pixelp(fpip->editp, 0));
-		draw(fp->hwnd);
+		if (on_update(fp->hwnd, fpip->w, fpip->h, fp->exfunc->get_disp_pixelp(fpip->editp, 0), fpip->frame))
+			draw(fp->hwnd);
+
+		// the frame is no longer guaranteed to live after this.
+		image.close_borrow();
 	}
 	return TRUE;
 }
@@ -1665,12 +2363,15 @@ static BOOL func_WndProc(HWND hwnd, UINT message, WPARAM wparam, LPARAM lparam,
 	DragState::context cxt{ .editp = editp, .wparam = wparam, .redraw_loupe = false, .redraw_main = false };
 
 	static constinit bool track_mouse_event_sent = false;
+	frame_source.editp = editp;
 	switch (message) {
 	case FilterMessage::Init:
 		this_dll = fp->dll_hinst;
+		frame_source.fp = fp;
 
 		// load settings.
 		load_settings();
+		image.use_large_pages(settings.performance.large_pages);
 
 		// disable IME.
 		::ImmReleaseContext(hwnd, ::ImmAssociateContext(hwnd, nullptr));
@@ -1685,10 +2386,41 @@ static BOOL func_WndProc(HWND hwnd, UINT message, WPARAM wparam, LPARAM lparam,
 	case FilterMessage::Exit:
 		// deactivate the toast manager.
 		toast_manager.set_host(nullptr);
+		idle_trimmer.stop();
 
 		// make sure new allocation would no longer occur.
 		ext_obj.deactivate();
 
+	#ifdef _DEBUG
+		// report the statistics of the memory and the caches to the debugger.
+		{
+			auto st = image.memory_stats();
+			char msg[128];
+			std::snprintf(msg, std::size(msg), "color_loupe: image memory peak %zu bytes (committed %zu), %u allocations.\n",
+				st.peak_live, st.peak_capacity, st.num_allocs);
+			::OutputDebugStringA(msg);
+
+			auto bs = back_buffer.stats();
+			std::snprintf(msg, std::size(msg), "color_loupe: back buffer %u allocations in %u frames.\n",
+				bs.num_allocs, bs.frames);
+			::OutputDebugStringA(msg);
+
+			auto const report = [&](const char* name, uint32_t hits, uint32_t misses) {
+				std::snprintf(msg, std::size(msg), "color_loupe: %s layer %u hits / %u draws.\n",
+					name, hits, hits + misses);
+				::OutputDebugStringA(msg);
+			};
+			report("picture", compositor.picture.hits, compositor.picture.misses);
+			report("scene", compositor.scene.hits, compositor.scene.misses);
+			report("overlay", compositor.overlay.hits, compositor.overlay.misses);
+
+			auto cs = chrome_sprites.stats();
+			std::snprintf(msg, std::size(msg), "color_loupe: chrome sprites %u hits / %u draws, %zu bytes.\n",
+				cs.hits, cs.hits + cs.misses, cs.bytes);
+			::OutputDebugStringA(msg);
+		}
+	#endif
+
 		// save settings.
 		save_settings();
 		break;
@@ -1699,7 +2431,7 @@ static BOOL func_WndProc(HWND hwnd, UINT message, WPARAM wparam, LPARAM lparam,
 			ext_obj.activate();
 
 			if (fp->exfunc->is_editing(editp) && !fp->exfunc->is_saving(editp))
-				on_update(editp->w1, editp->h1, fp->exfunc->get_disp_pixelp(editp, 0));
+				on_update(hwnd, editp->w1, editp->h1, fp->exfunc->get_disp_pixelp(editp, 0), fp->exfunc->get_frame(editp));
 			cxt.redraw_loupe = true;
 		}
 		else ext_obj.deactivate(), DragState::Abort(cxt);
@@ -1714,6 +2446,12 @@ static BOOL func_WndProc(HWND hwnd, UINT message, WPARAM wparam, LPARAM lparam,
 		break;
 
 	case WM_PAINT:
+		// the window might have been covered; the whole needs presenting.
+		compositor.overlay.valid = false;
+		cxt.redraw_loupe = true;
+		break;
+	case ToastManager::msg_erased:
+		// only the area of the toast needs repainting.
 		cxt.redraw_loupe = true;
 		break;
 
@@ -1887,6 +2625,7 @@ static BOOL func_WndProc(HWND hwnd, UINT message, WPARAM wparam, LPARAM lparam,
 			fp->exfunc->is_editing(editp) && !fp->exfunc->is_saving(editp)) draw(hwnd);
 		else draw_blank(hwnd);
 	}
+	image.close_borrow();
 
 	return cxt.redraw_main ? TRUE : FALSE;
 }
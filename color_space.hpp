@@ -0,0 +1,245 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+
+
+
+
+#pragma once
+
+#include <cstdint>
+#include <cmath>
+#include <array>
+#include <algorithm>
+
+#include "image_basics.hpp"
+
+////////////////////////////////
+// 色空間の変換．
+////////////////////////////////
+namespace sigma_lib::color_space
+{
+	using byte = uint8_t;
+
+	namespace details
+	{
+		// constexpr substitutes of <cmath>, by the Newton's method and the series.
+		// they're accurate enough for 8-bit colors, and replaced by <cmath> at runtime.
+		constexpr double root(double x, int n)
+		{
+			if (x <= 0) return 0;
+			double y = x > 1 ? x : 1; // approaches from above.
+			for (int i = 0; i < 64; i++) {
+				double p = 1;
+				for (int k = 1; k < n; k++) p *= y;
+				double const next = ((n - 1) * y + x / p) / n;
+				if (next >= y) break; // decreases until converged.
+				y = next;
+			}
+			return y;
+		}
+		constexpr double sqrt(double x) { return std::is_constant_evaluated() ? root(x, 2) : std::sqrt(x); }
+		constexpr double cbrt(double x) { return std::is_constant_evaluated() ? root(x, 3) : std::cbrt(x); }
+		// in degrees from 0 to 360.
+		constexpr double atan2_deg(double y, double x)
+		{
+			constexpr double pi = 3.14159265358979323846;
+			double a;
+			if (!std::is_constant_evaluated()) a = std::atan2(y, x);
+			else if (x == 0 && y == 0) a = 0;
+			else {
+				// reduce to |z| <= 1 and then halve the angle twice, for the series to converge fast.
+				bool const steep = (y < 0 ? -y : y) > (x < 0 ? -x : x);
+				double z = steep ? x / y : y / x;
+				z = z / (1 + root(1 + z * z, 2));
+				z = z / (1 + root(1 + z * z, 2));
+				double t = 0, p = z;
+				for (int k = 0; k < 16; k++, p *= -z * z) t += p / (2 * k + 1);
+				t *= 4;
+				if (steep) a = (y > 0 ? pi / 2 : -pi / 2) - t;
+				else a = x > 0 ? t : y >= 0 ? t + pi : t - pi;
+			}
+			a *= 180 / pi;
+			return a < 0 ? a + 360 : a;
+		}
+		constexpr int round(double x) { return static_cast<int>(x < 0 ? x - 0.5 : x + 0.5); }
+	}
+
+	// the linear light of each sRGB level, from 0 to 1.
+	constexpr auto srgb_to_linear = [] {
+		std::array<float, 256> ret{};
+		for (int i = 0; i < 256; i++) {
+			double const c = i / 255.0;
+			if (c <= 0.04045) ret[i] = static_cast<float>(c / 12.92);
+			else {
+				// x^2.4 = x^2 * (x^2)^(1/5).
+				double const t = (c + 0.055) / 1.055, t2 = t * t;
+				ret[i] = static_cast<float>(t2 * details::root(t2, 5));
+			}
+		}
+		return ret;
+	}();
+
+	// the hue in degrees from 0 to 359, and the others in percents.
+	struct HSV { int h, s, v; };
+	struct HLS { int h, l, s; };
+	// the 8-bit video range; Y from 16 to 235, Cb and Cr from 16 to 240.
+	struct YCbCr { int y, cb, cr; };
+	// CIE L*a*b* and L*C*h under D65, in tenths. the hue is from 0 to 3599.
+	struct Lab { int l, a, b; };
+	struct LCh { int l, c, h; };
+
+	enum class Matrix : uint8_t {
+		bt601 = 0, bt709 = 1,
+	};
+
+	// the hue of HSV and HLS in degrees. `mx` and `mn` are the largest and smallest of the three.
+	constexpr int hue(byte r, byte g, byte b, int mx, int mn)
+	{
+		int const d = mx - mn;
+		if (d == 0) return 0;
+		double h = mx == r ? 60.0 * (g - b) / d :
+			mx == g ? 120 + 60.0 * (b - r) / d : 240 + 60.0 * (r - g) / d;
+		int ret = details::round(h);
+		return ret < 0 ? ret + 360 : ret >= 360 ? ret - 360 : ret;
+	}
+	constexpr HSV to_hsv(byte r, byte g, byte b)
+	{
+		int const mx = std::max({ r, g, b }), mn = std::min({ r, g, b });
+		return {
+			hue(r, g, b, mx, mn),
+			mx == 0 ? 0 : details::round(100.0 * (mx - mn) / mx),
+			details::round(100.0 * mx / 255),
+		};
+	}
+	constexpr HLS to_hls(byte r, byte g, byte b)
+	{
+		int const mx = std::max({ r, g, b }), mn = std::min({ r, g, b }), sum = mx + mn;
+		return {
+			hue(r, g, b, mx, mn),
+			details::round(100.0 * sum / 510),
+			mx == mn ? 0 : details::round(100.0 * (mx - mn) / (sum <= 255 ? sum : 510 - sum)),
+		};
+	}
+
+	// the weights of R and B for the luma; G takes the rest.
+	constexpr double luma_kr(Matrix m) { return m == Matrix::bt709 ? 0.2126 : 0.299; }
+	constexpr double luma_kb(Matrix m) { return m == Matrix::bt709 ? 0.0722 : 0.114; }
+	constexpr YCbCr to_ycbcr(byte r, byte g, byte b, Matrix m)
+	{
+		double const kr = luma_kr(m), kb = luma_kb(m);
+		double const y = kr * r + (1 - kr - kb) * g + kb * b;
+		return {
+			details::round(16 + 219 * y / 255),
+			details::round(128 + 224 * (b - y) / (2 * (1 - kb)) / 255),
+			details::round(128 + 224 * (r - y) / (2 * (1 - kr)) / 255),
+		};
+	}
+
+	constexpr Lab to_lab(byte r, byte g, byte b)
+	{
+		double const R = srgb_to_linear[r], G = srgb_to_linear[g], B = srgb_to_linear[b];
+		// XYZ relative to the white point of D65.
+		double const
+			x = (0.4124564 * R + 0.3575761 * G + 0.1804375 * B) / 0.95047,
+			y = (0.2126729 * R + 0.7151522 * G + 0.0721750 * B),
+			z = (0.0193339 * R + 0.1191920 * G + 0.9503041 * B) / 1.08883;
+		constexpr double e = 216.0 / 24389, k = 24389.0 / 27;
+		auto const f = [](double t) { return t > e ? details::cbrt(t) : (k * t + 16) / 116; };
+		double const fx = f(x), fy = f(y), fz = f(z);
+		return {
+			details::round(10 * (116 * fy - 16)),
+			details::round(10 * 500 * (fx - fy)),
+			details::round(10 * 200 * (fy - fz)),
+		};
+	}
+	constexpr LCh to_lch(const Lab& lab)
+	{
+		int const c = details::round(details::sqrt(double(lab.a) * lab.a + double(lab.b) * lab.b));
+		int const h = c == 0 ? 0 : details::round(10 * details::atan2_deg(lab.b, lab.a)) % 3600;
+		return { lab.l, c, h };
+	}
+	constexpr LCh to_lch(byte r, byte g, byte b) { return to_lch(to_lab(r, g, b)); }
+
+	namespace details
+	{
+		// `(wb * B + wg * G + wr * R + bias) >> shift` of `n` pixels of B, G, R at `bgr`, into `dst`.
+		// the weights and the bias fit in 16 bits, and the results in 8 bits.
+		inline void weighted_span(const byte* bgr, byte* dst, int n, int wb, int wg, int wr, int bias, int shift)
+		{
+			int i = 0;
+		#ifdef SIGMA_LIB_IMAGE_SSE2
+			// pick 4 pixels into 32-bit lanes as B, G, R, 0, by shifting each into its lane.
+			auto const mask = [](int k) {
+				int v[4]{}; v[k] = 0x00ffffff;
+				return _mm_setr_epi32(v[0], v[1], v[2], v[3]);
+			};
+			auto const m0 = mask(0), m1 = mask(1), m2 = mask(2), m3 = mask(3);
+			auto const w = _mm_setr_epi16(
+				static_cast<int16_t>(wb), static_cast<int16_t>(wg), static_cast<int16_t>(wr), 0,
+				static_cast<int16_t>(wb), static_cast<int16_t>(wg), static_cast<int16_t>(wr), 0);
+			auto const zero = _mm_setzero_si128(), b4 = _mm_set1_epi32(bias);
+			auto const sh = _mm_cvtsi32_si128(shift);
+			// a load of 16 bytes covers 4 pixels and a third, so keep the last ones for the scalar loop.
+			for (; i + 6 <= n; i += 4) {
+				auto const v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bgr + 3 * i));
+				auto const px = _mm_or_si128(
+					_mm_or_si128(_mm_and_si128(v, m0), _mm_and_si128(_mm_slli_si128(v, 1), m1)),
+					_mm_or_si128(_mm_and_si128(_mm_slli_si128(v, 2), m2), _mm_and_si128(_mm_slli_si128(v, 3), m3)));
+				// (B*wb + G*wg, R*wr) for each pixel, and then the pairs are summed up.
+				auto const lo = _mm_castsi128_ps(_mm_madd_epi16(_mm_unpacklo_epi8(px, zero), w)),
+					hi = _mm_castsi128_ps(_mm_madd_epi16(_mm_unpackhi_epi8(px, zero), w));
+				auto sum = _mm_add_epi32(
+					_mm_castps_si128(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0))),
+					_mm_castps_si128(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1))));
+				sum = _mm_srl_epi32(_mm_add_epi32(sum, b4), sh);
+				sum = _mm_packs_epi32(sum, sum);
+				uint32_t const y4 = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_packus_epi16(sum, sum)));
+				dst[i] = static_cast<byte>(y4);
+				dst[i + 1] = static_cast<byte>(y4 >> 8);
+				dst[i + 2] = static_cast<byte>(y4 >> 16);
+				dst[i + 3] = static_cast<byte>(y4 >> 24);
+			}
+		#endif
+			for (; i < n; i++) {
+				const byte* p = bgr + 3 * i;
+				dst[i] = static_cast<byte>((wb * p[0] + wg * p[1] + wr * p[2] + bias) >> shift);
+			}
+		}
+	}
+
+	// the luma the loupe judges the brightness by, from 0 to 65535,
+	// the same as Color::luma() of color_abgr.hpp, which isn't available off Windows.
+	constexpr uint16_t color_luma(byte r, byte g, byte b) { return 77 * r + 151 * g + 29 * b; }
+	// the upper 8 bits of color_luma() of `n` pixels of B, G, R at `bgr`, into `dst`.
+	// a level of 128 or above is brighter than the half of the maximum.
+	inline void color_luma_span(const byte* bgr, byte* dst, int n)
+	{
+		details::weighted_span(bgr, dst, n, 29, 151, 77, 0, 8);
+	}
+
+	static_assert([] {
+		auto const hsv = to_hsv(255, 128, 0);
+		auto const hls = to_hls(0, 64, 128);
+		auto const ycc = to_ycbcr(255, 255, 255, Matrix::bt709);
+		auto const lab = to_lab(255, 0, 0);
+		auto const lch = to_lch(lab);
+		return hsv.h == 30 && hsv.s == 100 && hsv.v == 100 &&
+			hls.h == 210 && hls.l == 25 && hls.s == 100 &&
+			ycc.y == 235 && ycc.cb == 128 && ycc.cr == 128 &&
+			lab.l == 532 && lab.a == 801 && lab.b == 672 &&
+			lch.c == 1046 && lch.h == 400;
+	}());
+}
@@ -212,6 +212,9 @@ public:
 			{ IDS_CMD_CENTRALIZE, 		Command::centralize				},
 			{ IDS_CMD_BRING_CENTER, 	Command::bring_center			},
 			{ IDS_CMD_TOGGLE_GRID, 		Command::toggle_grid			},
+			{ IDS_CMD_TOGGLE_HISTOGRAM,	Command::toggle_histogram		},
+			{ IDS_CMD_TOGGLE_DIFFERENCE,	Command::toggle_difference		},
+			{ IDS_CMD_TOGGLE_LUT,		Command::toggle_lut				},
 			{ IDS_CMD_ZOOM_STEP_UP, 	Command::zoom_step_up			},
 			{ IDS_CMD_ZOOM_STEP_DOWN, 	Command::zoom_step_down			},
 			{ IDS_CMD_CXT_MENU, 		Command::context_menu			},
@@ -242,6 +245,9 @@ private:
 		case Command::centralize:			id = IDS_DESC_CMD_CENTRALIZE;	break;
 		case Command::bring_center:			id = IDS_DESC_CMD_BRING_CENTER;	break;
 		case Command::toggle_grid:			id = IDS_DESC_CMD_GRID;			break;
+		case Command::toggle_histogram:		id = IDS_DESC_CMD_HISTOGRAM;	break;
+		case Command::toggle_difference:	id = IDS_DESC_CMD_DIFFERENCE;	break;
+		case Command::toggle_lut:			id = IDS_DESC_CMD_LUT;			break;
 		case Command::zoom_step_up:			id = IDS_DESC_CMD_ZOOM_UP;		break;
 		case Command::zoom_step_down:		id = IDS_DESC_CMD_ZOOM_DOWN;	break;
 		case Command::context_menu:			id = IDS_DESC_CMD_CXT_MENU;		break;
@@ -690,6 +696,9 @@ public:
 private:
 	void on_change_color(ColorFormat data_new) { drag.color_fmt = data_new; }
 	void on_change_coord(CoordFormat data_new) { drag.coord_fmt = data_new; }
+	void on_change_stats_size(int8_t data_new) {
+		drag.stats_size = std::clamp(data_new, Settings::TipDrag::stats_size_min, Settings::TipDrag::stats_size_max);
+	}
 	void update_view() {
 		if (update_target != nullptr && update_target->hwnd != nullptr)
 			::PostMessageW(update_target->hwnd, PrvMsg::UpdateView, {}, {});
@@ -701,14 +710,23 @@ protected:
 	bool on_init(HWND) override
 	{
 		constexpr CtrlData<ColorFormat> combo_data[] = {
-			{ IDS_TIP_COLOR_FMT_HEX,	ColorFormat::hexdec6	},
-			{ IDS_TIP_COLOR_FMT_RGB,	ColorFormat::dec3x3		},
+			{ IDS_TIP_COLOR_FMT_HEX,	ColorFormat::hexdec6		},
+			{ IDS_TIP_COLOR_FMT_RGB,	ColorFormat::dec3x3			},
+			{ IDS_TIP_COLOR_FMT_MEAN,	ColorFormat::mean_hexdec6	},
+			{ IDS_TIP_COLOR_FMT_STATS,	ColorFormat::stats_dec3x3	},
+			{ IDS_TIP_COLOR_FMT_HSV,	ColorFormat::hsv			},
+			{ IDS_TIP_COLOR_FMT_HLS,	ColorFormat::hls			},
+			{ IDS_TIP_COLOR_FMT_Y601,	ColorFormat::ycbcr601		},
+			{ IDS_TIP_COLOR_FMT_Y709,	ColorFormat::ycbcr709		},
+			{ IDS_TIP_COLOR_FMT_LAB,	ColorFormat::lab			},
+			{ IDS_TIP_COLOR_FMT_LCH,	ColorFormat::lch			},
 		};
 
 		// suppress notifications from controls.
 		auto sc = suppress_callback();
 		init_combo_items(::GetDlgItem(hwnd, IDC_COMBO1), drag.color_fmt, combo_data);
 		init_combo_items(::GetDlgItem(hwnd, IDC_COMBO2), drag.coord_fmt, coord_combo_data);
+		init_spin(::GetDlgItem(hwnd, IDC_SPIN1), drag.stats_size, Settings::TipDrag::stats_size_min, Settings::TipDrag::stats_size_max);
 
 		return false;
 	}
@@ -731,6 +749,14 @@ protected:
 					return true;
 				}
 				break;
+			case EN_CHANGE:
+				switch (id) {
+				case IDC_EDIT1:
+					on_change_stats_size(get_spin_value(::GetDlgItem(hwnd, IDC_SPIN1)));
+					update_view();
+					return true;
+				}
+				break;
 			}
 			break;
 		}
@@ -1382,6 +1408,7 @@ private:
 	void on_change_thick(int8_t data_new) {
 		grid.least_zoom_thick = std::clamp(data_new, Grid::least_zoom_thick_min, Grid::least_zoom_thick_max);
 	}
+	void on_change_adaptive(bool data_new) { grid.adaptive = data_new; }
 	void set_text(int id, int level) {
 		wchar_t buf[std::size(L"0123.45")]{ L"----" };
 		if (level <= zoom_level_max) {
@@ -1411,6 +1438,8 @@ protected:
 		set_text(IDC_EDIT2, grid.least_zoom_thick);
 		::SendMessageW(::GetDlgItem(hwnd, IDC_EDIT3), WM_SETTEXT,
 			{}, reinterpret_cast<LPARAM>(res_str::get(IDS_DESC_GRID_KINDS)));
+		::SendMessageW(::GetDlgItem(hwnd, IDC_CHECK1), BM_SETCHECK,
+			grid.adaptive ? BST_CHECKED : BST_UNCHECKED, {});
 		return false;
 	}
 
@@ -1418,6 +1447,20 @@ protected:
 	{
 		auto ctrl = reinterpret_cast<HWND>(lparam);
 		switch (message) {
+		case WM_COMMAND:
+			switch (auto id = 0xffff & wparam, code = wparam >> 16; code) {
+			case BN_CLICKED:
+			{
+				bool checked = ::SendMessageW(ctrl, BM_GETCHECK, {}, {}) == BST_CHECKED;
+				switch (id) {
+				case IDC_CHECK1:
+					on_change_adaptive(checked);
+					return true;
+				}
+				break;
+			}
+			}
+			break;
 		case WM_HSCROLL:
 			switch (auto code = 0xffff & wparam) {
 			case TB_ENDTRACK:
@@ -1647,15 +1690,21 @@ protected:
 class command_clipboard_format : public dialog_base {
 	using ColorFormat = Settings::ColorFormat;
 	using CoordFormat = Settings::CoordFormat;
+	using ClickActions = Settings::ClickActions;
 
 public:
 	ColorFormat& color;
 	CoordFormat& coord;
-	command_clipboard_format(ColorFormat& color, CoordFormat& coord) : color{ color }, coord{ coord } {}
+	int8_t& stats_size;
+	command_clipboard_format(ColorFormat& color, CoordFormat& coord, int8_t& stats_size)
+		: color{ color }, coord{ coord }, stats_size{ stats_size } {}
 
 private:
 	void on_change_color(ColorFormat data_new) { color = data_new; }
 	void on_change_coord(CoordFormat data_new) { coord = data_new; }
+	void on_change_stats_size(int8_t data_new) {
+		stats_size = std::clamp(data_new, ClickActions::copy_stats_size_min, ClickActions::copy_stats_size_max);
+	}
 
 protected:
 	uintptr_t template_id() const override { return IDD_SETTINGS_FORM_CMD_CLIPBOARD; }
@@ -1663,14 +1712,24 @@ protected:
 	bool on_init(HWND) override
 	{
 		constexpr CtrlData<ColorFormat> combo_data[] = {
-			{ IDS_CXT_COLOR_FMT_HEX,	ColorFormat::hexdec6	},
-			{ IDS_CXT_COLOR_FMT_RGB,	ColorFormat::dec3x3		},
+			{ IDS_CXT_COLOR_FMT_HEX,	ColorFormat::hexdec6		},
+			{ IDS_CXT_COLOR_FMT_RGB,	ColorFormat::dec3x3			},
+			{ IDS_CXT_COLOR_FMT_MEAN,	ColorFormat::mean_hexdec6	},
+			{ IDS_CXT_COLOR_FMT_STATS,	ColorFormat::stats_dec3x3	},
+			{ IDS_CXT_COLOR_FMT_HSV,	ColorFormat::hsv			},
+			{ IDS_CXT_COLOR_FMT_HLS,	ColorFormat::hls			},
+			{ IDS_CXT_COLOR_FMT_Y601,	ColorFormat::ycbcr601		},
+			{ IDS_CXT_COLOR_FMT_Y709,	ColorFormat::ycbcr709		},
+			{ IDS_CXT_COLOR_FMT_LAB,	ColorFormat::lab			},
+			{ IDS_CXT_COLOR_FMT_LCH,	ColorFormat::lch			},
 		};
 
 		// suppress notifications from controls.
 		auto sc = suppress_callback();
 		init_combo_items(::GetDlgItem(hwnd, IDC_COMBO1), color, combo_data);
 		init_combo_items(::GetDlgItem(hwnd, IDC_COMBO2), coord, tip_drag_format::coord_combo_data);
+		init_spin(::GetDlgItem(hwnd, IDC_SPIN1), stats_size,
+			ClickActions::copy_stats_size_min, ClickActions::copy_stats_size_max);
 		::SendMessageW(::GetDlgItem(hwnd, IDC_EDIT1), WM_SETTEXT,
 			{}, reinterpret_cast<LPARAM>(res_str::get(IDS_DESC_CLIPBOARD_FMT)));
 
@@ -1693,6 +1752,13 @@ protected:
 					return true;
 				}
 				break;
+			case EN_CHANGE:
+				switch (id) {
+				case IDC_EDIT2:
+					on_change_stats_size(get_spin_value(::GetDlgItem(hwnd, IDC_SPIN1)));
+					return true;
+				}
+				break;
 			}
 			break;
 		}
@@ -2006,7 +2072,7 @@ private:
 			return new vscroll_form{
 				new command_swap_zoom{ curr.commands.swap_zoom_level_pivot },
 				new command_step_zoom{ curr.commands.step_zoom_pivot, curr.commands.step_zoom_num_steps },
-				new command_clipboard_format{ curr.commands.copy_color_fmt, curr.commands.copy_coord_fmt },
+				new command_clipboard_format{ curr.commands.copy_color_fmt, curr.commands.copy_coord_fmt, curr.commands.copy_stats_size },
 				new click_action_desc{},
 			};
 
@@ -0,0 +1,185 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+////////////////////////////////
+// 容量を保持するフレーム用メモリ確保．
+////////////////////////////////
+namespace sigma_lib::image
+{
+	// page-granular memory for a frame buffer that keeps its capacity
+	// when the requested size shrinks, so switching back and forth between sizes
+	// won't re-commit pages every time. the excess capacity is released
+	// after it has been unused for a number of ticks.
+	class FrameAllocator {
+	public:
+		// the minimum alignment of the returned memory, suitable for any SIMD loads/stores.
+		constexpr static size_t alignment = 64;
+
+		struct Stats {
+			size_t live;			// bytes currently requested.
+			size_t capacity;		// bytes currently committed.
+			size_t peak_live;		// the maximum of `live` so far.
+			size_t peak_capacity;	// the maximum of `capacity` so far.
+			uint32_t num_allocs;	// the number of times the memory was actually allocated.
+		};
+
+	private:
+		void* ptr = nullptr;
+		size_t live = 0, capacity = 0;
+		size_t peak_live = 0, peak_capacity = 0;
+		uint32_t num_allocs = 0;
+
+		// number of consecutive ticks the capacity was more than twice the live size.
+		uint32_t underused = 0;
+		uint32_t trim_ticks;
+		bool large_pages = false, is_large = false;
+
+		static size_t page_size(bool large)
+		{
+		#ifdef _WIN32
+			if (large) {
+				if (size_t sz = ::GetLargePageMinimum(); sz > 0) return sz;
+			}
+			SYSTEM_INFO si; ::GetSystemInfo(&si);
+			return si.dwPageSize;
+		#else
+			if (large) return size_t{ 2 } << 20;
+			return static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+		#endif
+		}
+		static void* os_alloc(size_t bytes, bool large)
+		{
+		#ifdef _WIN32
+			return ::VirtualAlloc(nullptr, bytes,
+				MEM_RESERVE | MEM_COMMIT | (large ? MEM_LARGE_PAGES : 0), PAGE_READWRITE);
+		#else
+			void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (p == MAP_FAILED) return nullptr;
+		#ifdef MADV_HUGEPAGE
+			if (large) ::madvise(p, bytes, MADV_HUGEPAGE);
+		#endif
+			return p;
+		#endif
+		}
+		static void os_free(void* p, size_t bytes)
+		{
+		#ifdef _WIN32
+			::VirtualFree(p, 0, MEM_RELEASE);
+		#else
+			::munmap(p, bytes);
+		#endif
+		}
+
+		// replaces the memory with the new one of at least `bytes`.
+		void reset(size_t bytes)
+		{
+			if (ptr != nullptr) os_free(ptr, capacity);
+			ptr = nullptr; capacity = 0; underused = 0;
+			if (bytes == 0) return;
+
+			// try large pages first if requested, then fall back to normal pages.
+			for (bool large : { large_pages, false }) {
+				auto const page = page_size(large);
+				auto const size = (bytes + page - 1) / page * page;
+				if ((ptr = os_alloc(size, large)) != nullptr) {
+					capacity = size; is_large = large;
+					num_allocs++;
+					peak_capacity = std::max(peak_capacity, capacity);
+					return;
+				}
+				if (!large) break;
+			}
+		}
+
+	public:
+		constexpr FrameAllocator(uint32_t trim_ticks = 120) : trim_ticks{ trim_ticks } {}
+		FrameAllocator(const FrameAllocator&) = delete;
+		~FrameAllocator() { release(); }
+
+		// returns the memory of at least `bytes`, aligned to `alignment`, or nullptr on failure.
+		// the contents are not preserved.
+		void* allocate(size_t bytes)
+		{
+			if (bytes == 0) { release(); return nullptr; }
+
+			if (bytes > capacity) reset(bytes);
+			else if (bytes <= capacity / 2 && trim_ticks == 0) reset(bytes);
+			live = ptr != nullptr ? bytes : 0;
+			peak_live = std::max(peak_live, live);
+			return ptr;
+		}
+
+		// call this once per frame. the excess capacity is released
+		// when it has been left unused for `trim_ticks` consecutive ticks.
+		void tick()
+		{
+			if (ptr == nullptr || live > capacity / 2) underused = 0;
+			else if (++underused >= trim_ticks) trim();
+		}
+
+		// releases the excess capacity now if more than half of it is unused,
+		// such as when the frames have stopped coming. the contents are preserved,
+		// though the memory might move; data() tells the new address.
+		void trim()
+		{
+			underused = 0;
+			if (ptr == nullptr || live > capacity / 2) return;
+
+			auto const old = ptr; auto const old_cap = capacity;
+			ptr = nullptr; capacity = 0;
+			reset(live);
+			if (ptr == nullptr) ptr = old, capacity = old_cap; // keep the old one on failure.
+			else {
+				std::copy_n(static_cast<const std::byte*>(old), live, static_cast<std::byte*>(ptr));
+				os_free(old, old_cap);
+			}
+		}
+
+		// releases the memory entirely.
+		void release()
+		{
+			reset(0);
+			live = 0;
+		}
+
+		// the bytes to be committed for a request of `bytes`, as counted in `Stats::capacity`.
+		size_t capacity_for(size_t bytes) const
+		{
+			if (bytes == 0) return 0;
+			auto const page = page_size(large_pages);
+			return (bytes + page - 1) / page * page;
+		}
+
+		// whether to use large pages for later allocations. falls back if unavailable.
+		void set_large_pages(bool large) { large_pages = large; }
+		bool uses_large_pages() const { return ptr != nullptr && is_large; }
+
+		constexpr void* data() const { return ptr; }
+		Stats stats() const { return { live, capacity, peak_live, peak_capacity, num_allocs }; }
+	};
+}
@@ -0,0 +1,59 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <cstdint>
+
+////////////////////////////////
+// 借用フレームの有効期限管理．
+////////////////////////////////
+namespace sigma_lib::image
+{
+	// manages a frame buffer owned by someone else, which can be read only during
+	// the "borrow window" it was lent. each window is identified by an epoch number,
+	// and closing the window invalidates all the tickets issued within it,
+	// so a stale pointer can never be obtained through a ticket.
+	class FrameBorrow {
+		const void* frame = nullptr;
+		uint32_t epoch = 1;
+
+	public:
+		struct Ticket {
+			uint32_t epoch = 0;
+			constexpr bool operator==(const Ticket&) const = default;
+		};
+
+		// opens a new borrow window with the `frame`, closing the previous if any.
+		constexpr Ticket lend(const void* frame)
+		{
+			close();
+			this->frame = frame;
+			return { epoch };
+		}
+
+		// closes the current borrow window. the frame is no longer accessible.
+		constexpr void close()
+		{
+			if (frame == nullptr) return;
+			frame = nullptr;
+			// 0 is reserved for the invalid ticket, and skipped when wrapping around.
+			if (++epoch == 0) epoch++;
+		}
+
+		// returns the frame if `ticket` belongs to the current window, or nullptr.
+		constexpr const void* get(const Ticket& ticket) const {
+			return frame != nullptr && ticket.epoch == epoch ? frame : nullptr;
+		}
+	};
+}
@@ -0,0 +1,194 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <array>
+#include <algorithm>
+
+#include "image_basics.hpp"
+#include "frame_alloc.hpp"
+
+////////////////////////////////
+// 前フレームとの差分表示．
+////////////////////////////////
+namespace sigma_lib::image
+{
+	// keeps the pixels of the current and the previous frames within the viewed areas,
+	// in buffers of the size of those areas, and maps the differences between them into false colors.
+	class FrameDiff {
+	public:
+		// the false colors in B, G, R for the largest difference among the channels.
+		// small differences are stretched, as the artifacts of compression are mostly a few levels.
+		constexpr static auto palette = [] {
+			struct stop { int at; byte r, g, b; };
+			constexpr stop stops[] = {
+				{ 0, 0, 0, 0 }, { 4, 0, 0, 128 }, { 16, 160, 0, 160 },
+				{ 48, 255, 64, 0 }, { 128, 255, 220, 0 }, { 255, 255, 255, 255 },
+			};
+			std::array<std::array<byte, 3>, 256> ret{};
+			for (int i = 0, k = 0; i < 256; i++) {
+				if (i > stops[k + 1].at) k++;
+				auto const& s0 = stops[k], & s1 = stops[k + 1];
+				int const t = i - s0.at, d = s1.at - s0.at;
+				auto const mix = [&](byte c0, byte c1) { return static_cast<byte>((c0 * (d - t) + c1 * t + d / 2) / d); };
+				ret[i] = { mix(s0.b, s1.b), mix(s0.g, s1.g), mix(s0.r, s1.r) };
+			}
+			return ret;
+		}();
+		// the color in B, G, R for the pixels whose previous frame isn't known.
+		constexpr static byte unknown = 0x40;
+
+		// the extra width kept around the captured rect, so the differences survive small moves of the view.
+		constexpr static int margin = 64;
+		// the frame number before any frame is captured.
+		constexpr static int no_frame = -1;
+
+	private:
+		FrameAllocator pools[2]{}, heat_pool{};
+		// the pixels of each frame within `held`, and the false colors within `heat_area`,
+		// each with its top-left corner at the corner of the rect in the image.
+		ImageView frames[2]{}, heat{};
+		Rect held[2]{}, heat_area{};
+		int curr = 0, frame = no_frame;
+		int src_width = 0, src_height = 0;
+
+		// the pixel at (`x`, `y`) of the image in the buffer of `rc`.
+		static byte* at(const ImageView& buf, const Rect& rc, int x, int y) { return buf.row(y - rc.top) + 3 * (x - rc.left); }
+
+		// makes `buf` cover the size of `rc`, or an empty view on failure.
+		static void reserve(FrameAllocator& pool, ImageView& buf, const Rect& rc)
+		{
+			auto const stride = ImageView::stride_of(rc.width());
+			buf = { static_cast<byte*>(pool.allocate(stride * rc.height())), rc.width(), rc.height(), stride };
+			if (buf.bits == nullptr) buf = {};
+		}
+
+		// `dst[i] = |a[i] - b[i]|` for each byte.
+		static void abs_diff(byte* dst, const byte* a, const byte* b, size_t len)
+		{
+			size_t i = 0;
+		#ifdef SIGMA_LIB_IMAGE_AVX2
+			for (; i + 32 <= len; i += 32) {
+				auto const x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)),
+					y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+					_mm256_or_si256(_mm256_subs_epu8(x, y), _mm256_subs_epu8(y, x)));
+			}
+		#endif
+		#ifdef SIGMA_LIB_IMAGE_SSE2
+			for (; i + 16 <= len; i += 16) {
+				auto const x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)),
+					y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+					_mm_or_si128(_mm_subs_epu8(x, y), _mm_subs_epu8(y, x)));
+			}
+		#endif
+			for (; i < len; i++) dst[i] = static_cast<byte>(a[i] > b[i] ? a[i] - b[i] : b[i] - a[i]);
+		}
+
+		// replaces the differences of `n` pixels with their false colors.
+		static void colorize(byte* p, int n)
+		{
+			for (; n > 0; n--, p += 3) {
+				auto const& c = palette[std::max({ p[0], p[1], p[2] })];
+				p[0] = c[0]; p[1] = c[1]; p[2] = c[2];
+			}
+		}
+
+	public:
+		// moves on to the frame numbered `number`; the current one becomes the previous.
+		// the same number is a re-render of the current frame, whose pixels are taken again
+		// while the previous frame stays.
+		void next_frame(int number)
+		{
+			if (number != frame) curr ^= 1;
+			frame = number;
+			held[curr] = Rect::empty();
+		}
+
+		// keeps the pixels of `src` within `rc` as of the current frame, along with the `margin` around
+		// as far as `available`, the area of `src` holding the current frame.
+		// the pixels held outside are dropped unless `rc` is already held.
+		void capture(const ImageView& src, Rect rc, const Rect& available)
+		{
+			if (src.width != src_width || src.height != src_height) {
+				// the frames of another size can't be compared.
+				held[0] = held[1] = Rect::empty();
+				src_width = src.width; src_height = src.height;
+			}
+
+			auto const whole = Rect::of_size(src.width, src.height);
+			rc &= whole;
+			if (rc.is_empty() || held[curr].contains(rc)) return;
+
+			auto const area = (rc.inflate(margin, margin) & available & whole) | rc;
+			reserve(pools[curr], frames[curr], area);
+			if (frames[curr].bits == nullptr) {
+				held[curr] = Rect::empty();
+				return;
+			}
+			for (int y = area.top; y < area.bottom; y++)
+				std::memcpy(at(frames[curr], area, area.left, y), src.row(y) + 3 * area.left, 3 * area.width());
+			held[curr] = area;
+		}
+
+		// computes the false colors of the differences within `rc` into heatmap().
+		// the pixels of `rc` must have been captured as of the current frame.
+		const ImageView& render(Rect rc)
+		{
+			rc &= held[curr];
+			reserve(heat_pool, heat, rc);
+			heat_area = heat.bits != nullptr ? rc : Rect::empty();
+			if (heat_area.is_empty()) return heat;
+
+			auto const& now = frames[curr];
+			auto const& last = frames[curr ^ 1];
+			auto const& now_area = held[curr];
+			auto const& last_area = held[curr ^ 1];
+			auto const known = rc & last_area;
+			for (int y = rc.top; y < rc.bottom; y++) {
+				byte* const d = at(heat, rc, rc.left, y);
+				int x0 = rc.left, x1 = rc.left;
+				if (!known.is_empty() && known.top <= y && y < known.bottom) {
+					x0 = known.left; x1 = known.right;
+					byte* const dk = d + 3 * (x0 - rc.left);
+					abs_diff(dk, at(now, now_area, x0, y), at(last, last_area, x0, y), 3 * (x1 - x0));
+					colorize(dk, x1 - x0);
+				}
+				std::memset(d, unknown, 3 * (x0 - rc.left));
+				std::memset(d + 3 * (x1 - rc.left), unknown, 3 * (rc.right - x1));
+			}
+			return heat;
+		}
+
+		// the false colors of the last render(), covering heatmap_area() of the frames.
+		constexpr const ImageView& heatmap() const { return heat; }
+		// the area of the frames heatmap() covers, empty if nothing is rendered.
+		constexpr const Rect& heatmap_area() const { return heat_area; }
+
+		void release()
+		{
+			for (auto& pool : pools) pool.release();
+			heat_pool.release();
+			for (auto& buf : frames) buf = {};
+			heat = {};
+			held[0] = held[1] = heat_area = Rect::empty();
+			frame = no_frame;
+		}
+	};
+}
@@ -0,0 +1,169 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <utility>
+
+#include "image_basics.hpp"
+#include "frame_alloc.hpp"
+
+////////////////////////////////
+// グリフのアトラスによる文字列描画．
+////////////////////////////////
+namespace sigma_lib::image
+{
+	// keeps the coverage of the printable ASCII glyphs of a font in a strip,
+	// to measure and draw short strings without the text APIs of the system.
+	// the glyphs are rasterized by the caller, as white text on black at the cells laid out by layout().
+	class GlyphAtlas {
+	public:
+		constexpr static wchar_t first_char = L' ', last_char = L'~';
+		constexpr static int num_glyphs = last_char - first_char + 1;
+
+		struct Glyph {
+			int32_t x;			// the position of the cell in the strip.
+			int32_t left;		// the offset of the cell from the pen position.
+			int32_t width;		// the width of the cell.
+			int32_t advance;	// the amount the pen moves by.
+		};
+
+	private:
+		FrameAllocator pool{};
+		Glyph glyphs[num_glyphs]{};
+		byte* coverage = nullptr;
+		int strip_width = 0, line_height = 0;
+
+		constexpr static bool in_range(wchar_t c) { return first_char <= c && c <= last_char; }
+		constexpr const Glyph& glyph(wchar_t c) const { return glyphs[c - first_char]; }
+
+		// the width of the line starting at `str`, and its length up to the line break or the end.
+		std::pair<int, int> measure_line(const wchar_t* str, int len) const
+		{
+			int w = 0, n = 0;
+			for (; n < len && str[n] != L'\n'; n++) w += glyph(str[n]).advance;
+			return { w, n };
+		}
+
+		// blends the color onto `dst` by the coverage of the glyph, whose cell starts at (`x`, `y`).
+		void blend(const ImageView& dst, int x, int y, const Glyph& g, const byte(&bgr)[3]) const
+		{
+			int const x0 = std::max(0, -x), x1 = std::min(g.width, dst.width - x),
+				y0 = std::max(0, -y), y1 = std::min(line_height, dst.height - y);
+			for (int j = y0; j < y1; j++) {
+				const byte* const cov = coverage + static_cast<size_t>(j) * strip_width + g.x;
+				byte* const row = dst.row(y + j) + dst.depth * x;
+				for (int i = x0; i < x1; i++) {
+					int a = cov[i];
+					if (a == 0) continue;
+					a += a >> 7; // 0..256.
+					byte* const p = row + dst.depth * i;
+					for (int k = 0; k < 3; k++) p[k] = static_cast<byte>(p[k] + (((bgr[k] - p[k]) * a) >> 8));
+				}
+			}
+		}
+
+	public:
+		// assigns the positions in the strip to the cells of `glyphs`, whose other fields are set.
+		// returns the width of the strip.
+		static int layout(Glyph(&glyphs)[num_glyphs])
+		{
+			int x = 0;
+			for (auto& g : glyphs) {
+				g.width = std::max(g.width, 0);
+				g.x = x; x += g.width;
+			}
+			return x;
+		}
+
+		// takes the glyphs drawn on `image` in white on black, at the cells of `layout` and of `height`.
+		// returns false on failure, leaving the atlas invalid.
+		bool build(const Glyph(&layout)[num_glyphs], int height, const ImageView& image)
+		{
+			release();
+			int const w = std::min(layout[num_glyphs - 1].x + layout[num_glyphs - 1].width, image.width),
+				h = std::min(height, image.height);
+			if (w <= 0 || h <= 0) return false;
+
+			coverage = static_cast<byte*>(pool.allocate(static_cast<size_t>(w) * h));
+			if (coverage == nullptr) return false;
+			strip_width = w; line_height = h;
+			std::memcpy(glyphs, layout, sizeof(glyphs));
+
+			// the green channel tells the coverage even with sub-pixel rendering.
+			for (int y = 0; y < h; y++) {
+				const byte* const src = image.row(y);
+				byte* const dst = coverage + static_cast<size_t>(y) * w;
+				for (int x = 0; x < w; x++) dst[x] = src[3 * x + 1];
+			}
+			return true;
+		}
+
+		constexpr bool is_valid() const { return coverage != nullptr; }
+		constexpr int height() const { return line_height; }
+
+		// whether all the characters, except line breaks, are in the atlas.
+		constexpr bool covers(const wchar_t* str, int len) const
+		{
+			for (int i = 0; i < len; i++) {
+				if (str[i] != L'\n' && !in_range(str[i])) return false;
+			}
+			return true;
+		}
+
+		// the size of the text as { width, height }, in the same way as DrawTextW() with DT_CALCRECT.
+		// the characters must be covered by the atlas.
+		std::pair<int, int> measure(const wchar_t* str, int len) const
+		{
+			int w = 0, lines = 0;
+			for (int i = 0; i <= len; lines++) {
+				auto [lw, n] = measure_line(str + i, len - i);
+				w = std::max(w, lw);
+				i += n + 1;
+			}
+			return { w, lines * line_height };
+		}
+
+		// draws the text with the top-left at (`left`, `top`), in the color of COLORREF.
+		// each line is centered in `width` if `center` is true. `dst` can be of 32bpp.
+		void draw(const ImageView& dst, int left, int top, int width, bool center,
+			const wchar_t* str, int len, uint32_t colorref) const
+		{
+			byte const bgr[3] = {
+				static_cast<byte>(colorref >> 16), static_cast<byte>(colorref >> 8), static_cast<byte>(colorref),
+			};
+			for (int i = 0, y = top; i <= len; y += line_height) {
+				auto [lw, n] = measure_line(str + i, len - i);
+				int x = center ? left + (width - lw) / 2 : left;
+				for (int k = i; k < i + n; k++) {
+					auto const& g = glyph(str[k]);
+					blend(dst, x + g.left, y, g, bgr);
+					x += g.advance;
+				}
+				i += n + 1;
+			}
+		}
+
+		void release()
+		{
+			pool.release();
+			coverage = nullptr;
+			strip_width = line_height = 0;
+		}
+	};
+}
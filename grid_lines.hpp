@@ -0,0 +1,96 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+#pragma once
+
+#include <cstdint>
+
+#include "image_basics.hpp"
+#include "canvas.hpp"
+
+////////////////////////////////
+// グリッドの線ごとの描画．
+////////////////////////////////
+namespace sigma_lib::image
+{
+	// draws the thin grid by inverting the pixels, one call per line.
+	inline void draw_grid_thin(Canvas& canvas, const Rect& vb, const Rect& vp)
+	{
+		int w = vb.right - vb.left, W = vp.right - vp.left,
+			h = vb.bottom - vb.top, H = vp.bottom - vp.top;
+
+		for (int x = vb.left; x < vb.right; x++) {
+			auto X = (x - vb.left) * W / w + vp.left;
+			canvas.invert_rect({ X, vp.top, X + 1, vp.bottom });
+		}
+		for (int y = vb.top; y < vb.bottom; y++) {
+			auto Y = (y - vb.top) * H / h + vp.top;
+			canvas.invert_rect({ vp.left, Y, vp.right, Y + 1 });
+		}
+	}
+
+	// draws the thick grid in six passes of the colors `c`, from the most significant lines to the least,
+	// one call per line.
+	inline void draw_grid_thick(Canvas& canvas, const Rect& vb, const Rect& vp, const uint32_t(&c)[6])
+	{
+		int w = vb.right - vb.left, W = vp.right - vp.left,
+			h = vb.bottom - vb.top, H = vp.bottom - vp.top;
+
+		uint32_t color = 0;
+
+		auto hline = [&](int y) { canvas.fill_rect({ vp.left, y, vp.right, y + 1 }, color); };
+		auto vline = [&](int x) { canvas.fill_rect({ x, vp.top, x + 1, vp.bottom }, color); };
+
+		// least significant lines.
+		color = c[3];
+		for (int x = vb.left; x < vb.right; x++) {
+			if (x % 5 != 0) vline((x - vb.left) * W / w + vp.left);
+		}
+		for (int y = vb.top; y < vb.bottom; y++) {
+			if (y % 5 != 0) hline((y - vb.top) * H / h + vp.top);
+		}
+		color = c[2];
+		for (int x = vb.left + 1; x <= vb.right; x++) {
+			if (x % 5 != 0) vline((x - vb.left) * W / w + vp.left - 1);
+		}
+		for (int y = vb.top + 1; y <= vb.bottom; y++) {
+			if (y % 5 != 0) hline((y - vb.top) * H / h + vp.top - 1);
+		}
+
+		// multiple of 5, but not 10.
+		color = c[4];
+		for (int x = vb.left + 9 - ((vb.left + 4) % 10); x < vb.right; x += 10)
+			vline((x - vb.left) * W / w + vp.left);
+		for (int y = vb.top + 9 - ((vb.top + 4) % 10); y < vb.bottom; y += 10)
+			hline((y - vb.top) * H / h + vp.top);
+		color = c[1];
+		for (int x = vb.left + 10 - ((vb.left + 5) % 10); x <= vb.right; x += 10)
+			vline((x - vb.left) * W / w + vp.left - 1);
+		for (int y = vb.top + 10 - ((vb.top + 5) % 10); y <= vb.bottom; y += 10)
+			hline((y - vb.top) * H / h + vp.top - 1);
+
+		// multiple of 10.
+		color = c[5];
+		for (int x = vb.left + 9 - ((vb.left + 9) % 10); x < vb.right; x += 10)
+			vline((x - vb.left) * W / w + vp.left);
+		for (int y = vb.top + 9 - ((vb.top + 9) % 10); y < vb.bottom; y += 10)
+			hline((y - vb.top) * H / h + vp.top);
+		color = c[0];
+		for (int x = vb.left + 10 - (vb.left % 10); x <= vb.right; x += 10)
+			vline((x - vb.left) * W / w + vp.left - 1);
+		for (int y = vb.top + 10 - (vb.top % 10); y <= vb.bottom; y += 10)
+			hline((y - vb.top) * H / h + vp.top - 1);
+	}
+}
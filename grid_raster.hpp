@@ -0,0 +1,394 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+#include "image_basics.hpp"
+#include "color_space.hpp"
+#include "frame_alloc.hpp"
+#include "strip_pool.hpp"
+
+////////////////////////////////
+// グリッドのソフトウェア描画．
+////////////////////////////////
+namespace sigma_lib::image
+{
+	// draws the grid lines directly onto 24bpp or 32bpp images,
+	// with the same result as the GDI drawing in the loupe.
+	// the classes of the lines are computed once per view, and reused while the view stays.
+	class GridRaster {
+	public:
+		constexpr static int max_tiles = 4;
+		// bands for parallel drawing have at least this number of rows.
+		constexpr static int min_band_rows = 32;
+
+	private:
+		FrameAllocator pool{}, row_pool{};
+
+		// one period of the grid, 10 source pixels, at an integer scale.
+		// with integer scales the grid is periodic on the screen,
+		// so views scrolled around can be made by wrapping the tile.
+		struct Tile {
+			FrameAllocator pool{};
+			int scale = 0, depth = 0;
+			uint8_t thick = 0;
+			uint32_t colors[6]{};
+			uint32_t last_used = 0;
+
+			// the classes of the columns, and the patterns of the rows, in the period.
+			int8_t* cls = nullptr;
+			byte* patterns = nullptr;
+
+			constexpr int period() const { return 10 * scale; }
+		} tiles[max_tiles]{};
+		int tile_capacity = max_tiles;
+		uint32_t tile_clock = 0;
+
+		// the state the classes were computed for.
+		Rect vb{}, vp{}, area{};
+		int depth = 3;
+		uint8_t thick = 0;
+		uint32_t colors[6]{};
+		bool valid = false;
+
+		// per-column and per-row classes, relative to `area`.
+		// for thick grids, the rank of the last pass drawn over, or -1 if none.
+		// for thin grids, the parity of the number of lines drawn over.
+		int8_t* cls_v = nullptr;
+		int8_t* cls_h = nullptr;
+
+		// columns that have any line, relative to `area`.
+		int32_t* cols = nullptr;
+		int num_cols = 0;
+		// the source column for each column, relative to `area` and `vb`.
+		int32_t* src_x = nullptr;
+
+		// for thick grids, the row for each pass of horizontal lines, with vertical lines over it.
+		// for thin grids, the xor mask for the rows with horizontal lines.
+		byte* patterns = nullptr;
+		// the pixel values of the columns in `cols`, for the rows without horizontal lines.
+		byte* col_pixels = nullptr;
+
+		// the order of the passes in draw_grid_thick(), as the indices to `colors`.
+		constexpr static int pass_colors[6] = { 3, 2, 4, 1, 5, 0 };
+
+		// iterates the positions of lines in the same way as draw_grid_thick(), calling `mark(pos, pass)`.
+		static void thick_lines(int vb_l, int vb_r, int vp_l, int vp_r, auto&& mark)
+		{
+			int const w = vb_r - vb_l, W = vp_r - vp_l;
+			auto const pos = [&](int x) { return (x - vb_l) * W / w + vp_l; };
+
+			// least significant lines.
+			for (int x = vb_l; x < vb_r; x++) if (x % 5 != 0) mark(pos(x), 0);
+			for (int x = vb_l + 1; x <= vb_r; x++) if (x % 5 != 0) mark(pos(x) - 1, 1);
+			// multiple of 5, but not 10.
+			for (int x = vb_l + 9 - ((vb_l + 4) % 10); x < vb_r; x += 10) mark(pos(x), 2);
+			for (int x = vb_l + 10 - ((vb_l + 5) % 10); x <= vb_r; x += 10) mark(pos(x) - 1, 3);
+			// multiple of 10.
+			for (int x = vb_l + 9 - ((vb_l + 9) % 10); x < vb_r; x += 10) mark(pos(x), 4);
+			for (int x = vb_l + 10 - (vb_l % 10); x <= vb_r; x += 10) mark(pos(x) - 1, 5);
+		}
+		// iterates the positions of lines in the same way as draw_grid_thin().
+		static void thin_lines(int vb_l, int vb_r, int vp_l, int vp_r, auto&& mark)
+		{
+			int const w = vb_r - vb_l, W = vp_r - vp_l;
+			for (int x = vb_l; x < vb_r; x++) mark((x - vb_l) * W / w + vp_l, 0);
+		}
+
+		static void put(byte* p, uint32_t colorref) {
+			p[0] = static_cast<byte>(colorref >> 16);
+			p[1] = static_cast<byte>(colorref >> 8);
+			p[2] = static_cast<byte>(colorref);
+		}
+
+		// computes `cls` of `len` entries in the same way as the loops of draw_grid_*().
+		// the positions are in the screen coordinate shifted by `lo`.
+		void classify(int8_t* cls, int len, int lo, int vb_l, int vb_r, int vp_l, int vp_r, int bias) const
+		{
+			// horizontal lines are drawn after the vertical ones of the same pass, so ranked one higher.
+			auto const mark = [=, this](int pos, int pass) {
+				if (pos < lo || pos >= lo + len) return;
+				if (thick > 1) cls[pos - lo] = static_cast<int8_t>(2 * pass + bias);
+				else cls[pos - lo] ^= 1;
+			};
+			std::memset(cls, thick > 1 ? -1 : 0, len);
+			if (thick > 1) thick_lines(vb_l, vb_r, vp_l, vp_r, mark);
+			else thin_lines(vb_l, vb_r, vp_l, vp_r, mark);
+		}
+
+		// makes the patterns of the rows with horizontal lines, from the classes of `len` columns.
+		void make_patterns(byte* pat, const int8_t* cls, int len) const
+		{
+			size_t const row_bytes = depth * static_cast<size_t>(len);
+			// the unused bytes of 32bpp pixels are left zero.
+			if (depth > 3) std::memset(pat, 0, (thick > 1 ? 6 : 1) * row_bytes);
+			if (thick > 1) {
+				for (int pass = 0; pass < 6; pass++) {
+					byte* const row = pat + pass * row_bytes;
+					int const rank = 2 * pass + 1;
+					for (int x = 0; x < len; x++)
+						put(row + depth * x, colors[pass_colors[std::max<int>(cls[x], rank) >> 1]]);
+				}
+			}
+			else {
+				// invert the pixels without vertical lines, as the intersections are inverted twice.
+				for (int x = 0; x < len; x++)
+					std::memset(pat + depth * x, cls[x] != 0 ? 0x00 : 0xff, 3);
+			}
+		}
+
+		// finds the tile for the scale, or makes one evicting the least recently used.
+		const Tile& tile_for(int scale)
+		{
+			Tile* found = nullptr;
+			for (int i = 0; i < tile_capacity; i++) {
+				auto& t = tiles[i];
+				if (t.scale == scale && t.depth == depth && t.thick == thick &&
+					std::memcmp(t.colors, colors, sizeof(colors)) == 0) {
+					found = &t;
+					break;
+				}
+				if (found == nullptr || t.last_used < found->last_used) found = &t;
+			}
+			auto& tile = *found;
+			tile.last_used = ++tile_clock;
+			if (tile.cls != nullptr && tile.scale == scale && tile.depth == depth && tile.thick == thick &&
+				std::memcmp(tile.colors, colors, sizeof(colors)) == 0) return tile;
+
+			// render the period at [20, 30) of the source, away from the ends of the loops.
+			tile.scale = scale; tile.depth = depth; tile.thick = thick;
+			std::memcpy(tile.colors, colors, sizeof(colors));
+			int const P = tile.period();
+			size_t const sz_cls = (P + 7) & ~size_t{ 7 };
+			auto p = static_cast<byte*>(tile.pool.allocate(sz_cls + (thick > 1 ? 6 : 1) * depth * static_cast<size_t>(P)));
+			tile.cls = reinterpret_cast<int8_t*>(p);
+			tile.patterns = p + sz_cls;
+			classify(tile.cls, P, 20 * scale, 10, 40, 10 * scale, 40 * scale, 0);
+			make_patterns(tile.patterns, tile.cls, P);
+			return tile;
+		}
+
+		// fills `len` bytes of `dst` with the repetition of `period` bytes of `src`, starting at `phase`.
+		static void fill_periodic(void* dst, const void* src, size_t period, size_t phase, size_t len)
+		{
+			auto const d = static_cast<byte*>(dst);
+			auto const s = static_cast<const byte*>(src);
+			size_t n = std::min(len, period - phase);
+			std::memcpy(d, s + phase, n);
+			for (; n < len; n += period) std::memcpy(d + n, s, std::min(period, len - n));
+		}
+
+		void prepare()
+		{
+			int const aw = area.width(), ah = area.height();
+			size_t const row_bytes = depth * static_cast<size_t>(aw),
+				num_patterns = thick > 1 ? 6 : 1;
+
+			// carve the arrays out of a single allocation.
+			size_t const sz_cls = (aw + ah + 7) & ~size_t{ 7 },
+				sz_cols = sizeof(int32_t) * aw,
+				sz_pat = num_patterns * row_bytes,
+				sz_pix = row_bytes;
+			auto p = static_cast<byte*>(pool.allocate(sz_cls + 2 * sz_cols + sz_pat + sz_pix));
+			cls_v = reinterpret_cast<int8_t*>(p); cls_h = cls_v + aw; p += sz_cls;
+			cols = reinterpret_cast<int32_t*>(p); p += sz_cols;
+			src_x = reinterpret_cast<int32_t*>(p); p += sz_cols;
+			patterns = p; p += sz_pat;
+			col_pixels = p;
+
+			// classify the columns and the rows.
+			int const scale = vp.width() / vb.width();
+			if (scale > 0 && tile_capacity > 0 &&
+				vp.width() == scale * vb.width() && vp.height() == scale * vb.height()) {
+				// wrap the tile, whose origin is at the multiples of 10 of the source.
+				auto const& tile = tile_for(scale);
+				int const P = tile.period();
+				auto const phase = [P](int v) { v %= P; return v < 0 ? v + P : v; };
+				int const phase_x = phase(area.left - (vp.left - scale * vb.left)),
+					phase_y = phase(area.top - (vp.top - scale * vb.top));
+				fill_periodic(cls_v, tile.cls, P, phase_x, aw);
+				fill_periodic(cls_h, tile.cls, P, phase_y, ah);
+				if (thick > 1) {
+					for (int y = 0; y < ah; y++) if (cls_h[y] >= 0) cls_h[y]++;
+				}
+				for (size_t i = 0; i < num_patterns; i++)
+					fill_periodic(patterns + i * row_bytes, tile.patterns + i * depth * P, depth * P, depth * phase_x, row_bytes);
+			}
+			else {
+				classify(cls_v, aw, area.left, vb.left, vb.right, vp.left, vp.right, 0);
+				classify(cls_h, ah, area.top, vb.top, vb.bottom, vp.top, vp.bottom, 1);
+				make_patterns(patterns, cls_v, aw);
+			}
+
+			// the columns with lines, and their pixels on the rows without lines.
+			num_cols = 0;
+			for (int x = 0; x < aw; x++) {
+				if (thick > 1 ? cls_v[x] < 0 : cls_v[x] == 0) continue;
+				if (thick > 1) put(col_pixels + depth * num_cols, colors[pass_colors[cls_v[x] >> 1]]);
+				cols[num_cols++] = x;
+			}
+
+			// the source columns, by the same mapping as the picture.
+			for (int i = 0, w = vb.width(), W = vp.width(); i < w; i++) {
+				int const l = std::max(i * W / w + vp.left, area.left),
+					r = std::min((i + 1) * W / w + vp.left, area.right);
+				for (int x = l; x < r; x++) src_x[x - area.left] = i;
+			}
+		}
+
+		// the color of a line of `rank` on pixels of the given brightness,
+		// keeping the significance of the line but choosing the side of contrast.
+		uint32_t adaptive_color(int rank, bool bright) const
+		{
+			// `colors` are dark ones from the most significant, followed by their negations.
+			int const c = pass_colors[rank >> 1], sig = c < 3 ? c : 5 - c;
+			return colors[bright ? sig : 5 - sig];
+		}
+
+		// updates the cached classes for the view. returns false if nothing to draw.
+		bool update(const ImageView& dst, const Rect& view_box, const Rect& view_port,
+			uint8_t grid_thick, const uint32_t(&thick_colors)[6])
+		{
+			if (grid_thick == 0 || view_box.is_empty()) return false;
+			auto const clip = view_port & Rect::of_size(dst.width, dst.height);
+			if (clip.is_empty()) return false;
+
+			grid_thick = grid_thick > 1 ? 2 : 1;
+			if (!valid || vb != view_box || vp != view_port || area != clip || depth != dst.depth || thick != grid_thick ||
+				std::memcmp(colors, thick_colors, sizeof(colors)) != 0) {
+				vb = view_box; vp = view_port; area = clip; depth = dst.depth; thick = grid_thick;
+				std::memcpy(colors, thick_colors, sizeof(colors));
+				prepare();
+				valid = true;
+			}
+			return true;
+		}
+
+		// xors `n` bytes of `dst` with `mask`.
+		static void xor_bytes(byte* dst, const byte* mask, size_t n)
+		{
+			size_t i = 0;
+		#ifdef SIGMA_LIB_IMAGE_SSE2
+			for (; i + 16 <= n; i += 16) {
+				auto const d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i)),
+					m = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask + i));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(d, m));
+			}
+		#endif
+			for (; i < n; i++) dst[i] ^= mask[i];
+		}
+
+	public:
+		// draws the grid onto `dst`. `grid_thick` is 1 for the thin grid or 2 for the thick.
+		// `thick_colors` are those of the thick grid, from the most significant lines to the least.
+		// with `strips`, the rows are split into bands drawn in parallel.
+		void draw(const ImageView& dst, const Rect& view_box, const Rect& view_port,
+			uint8_t grid_thick, const uint32_t(&thick_colors)[6], StripPool* strips = nullptr)
+		{
+			if (!update(dst, view_box, view_port, grid_thick, thick_colors)) return;
+
+			size_t const row_bytes = depth * static_cast<size_t>(area.width());
+			auto const draw_rows = [&](int y_lo, int y_hi) {
+				for (int y = y_lo; y < y_hi; y++) {
+					byte* const row = dst.row(y) + depth * area.left;
+					int const c = cls_h[y - area.top];
+					if (thick > 1) {
+						if (c >= 0) std::memcpy(row, patterns + (c >> 1) * row_bytes, row_bytes);
+						else for (int i = 0; i < num_cols; i++)
+							std::memcpy(row + depth * cols[i], col_pixels + depth * i, 3);
+					}
+					else {
+						if (c != 0) xor_bytes(row, patterns, row_bytes);
+						else for (int i = 0; i < num_cols; i++) {
+							byte* const p = row + depth * cols[i];
+							p[0] ^= 0xff; p[1] ^= 0xff; p[2] ^= 0xff;
+						}
+					}
+				}
+			};
+
+			int const ah = area.height(),
+				num_bands = strips == nullptr ? 1 : std::clamp(std::min(4 * strips->threads(), ah / min_band_rows), 1, ah);
+			if (num_bands <= 1) draw_rows(area.top, area.bottom);
+			else strips->run(num_bands, [&](int b) {
+				draw_rows(area.top + static_cast<int>(static_cast<int64_t>(ah) * b / num_bands),
+					area.top + static_cast<int>(static_cast<int64_t>(ah) * (b + 1) / num_bands));
+			});
+		}
+
+		// draws the grid with the colors chosen by the content under each line segment;
+		// dark colors on bright pixels and light colors on dark pixels.
+		// a pixel is bright when its Color::luma() exceeds the half of the maximum,
+		// judged by the lanes once per source row in `view_box` of `src`, where pixels outside count as dark,
+		// and the results are expanded to the screen pixels of the lines.
+		// the thin grid uses the most significant colors of `thick_colors`.
+		void draw_adaptive(const ImageView& dst, const ImageView& src, const Rect& view_box, const Rect& view_port,
+			uint8_t grid_thick, const uint32_t(&thick_colors)[6])
+		{
+			if (!update(dst, view_box, view_port, grid_thick, thick_colors)) return;
+
+			int const aw = area.width(), w = vb.width(), h = vb.height(), H = vp.height();
+			// the columns of the source inside `src`, and the upper 8 bits of the luma of the row.
+			int const x0 = std::clamp(-vb.left, 0, w), x1 = std::clamp(src.width - vb.left, x0, w);
+			auto const luma = static_cast<byte*>(row_pool.allocate(w));
+			std::memset(luma, 0, w);
+			int sy = -1;
+			for (int y = area.top; y < area.bottom; y++) {
+				// move to the source row covering this row, and classify its pixels.
+				int const sy_prev = sy;
+				while (sy + 1 < h && (sy + 1) * H / h + vp.top <= y) sy++;
+				if (sy != sy_prev) {
+					int const src_y = vb.top + sy;
+					if (0 <= src_y && src_y < src.height)
+						color_space::color_luma_span(src.row(src_y) + 3 * (vb.left + x0), luma + x0, x1 - x0);
+					else std::memset(luma + x0, 0, x1 - x0);
+				}
+
+				byte* const row = dst.row(y) + depth * area.left;
+				int const c = cls_h[y - area.top];
+				auto const color_at = [&](int x, int rank) { return adaptive_color(rank, luma[src_x[x]] >= 128); };
+				if (thick > 1) {
+					if (c >= 0) for (int x = 0; x < aw; x++) put(row + depth * x, color_at(x, std::max<int>(cls_v[x], c)));
+					else for (int i = 0; i < num_cols; i++) put(row + depth * cols[i], color_at(cols[i], cls_v[cols[i]]));
+				}
+				else {
+					// intersections are lines too, unlike the inverting grid.
+					if (c != 0) for (int x = 0; x < aw; x++) put(row + depth * x, color_at(x, 10));
+					else for (int i = 0; i < num_cols; i++) put(row + depth * cols[i], color_at(cols[i], 10));
+				}
+			}
+		}
+
+		// limits the number of tiles to keep, such as the number of zoom levels with grids.
+		void set_tile_capacity(int capacity)
+		{
+			capacity = std::clamp(capacity, 0, max_tiles);
+			if (capacity == tile_capacity) return;
+			for (int i = capacity; i < max_tiles; i++) tiles[i].pool.release(), tiles[i].cls = nullptr;
+			tile_capacity = capacity;
+			valid = false;
+		}
+
+		void release()
+		{
+			pool.release(); row_pool.release();
+			for (auto& tile : tiles) tile.pool.release(), tile.cls = nullptr;
+			valid = false;
+		}
+	};
+}
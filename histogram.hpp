@@ -0,0 +1,182 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+
+#include "image_basics.hpp"
+#include "frame_alloc.hpp"
+#include "strip_pool.hpp"
+#include "color_space.hpp"
+
+////////////////////////////////
+// 表示範囲のヒストグラム．
+////////////////////////////////
+namespace sigma_lib::image
+{
+	// the counts of the pixels in a rectangle of the image for each value of B, G, R
+	// and the luma of Color::luma(), the same one the adaptive grid is colored by.
+	// when the rectangle moves, only the strips leaving and entering it are counted again.
+	class Histogram {
+	public:
+		enum Channel : int {
+			blue = 0, green = 1, red = 2, luma = 3,
+			num_channels = 4,
+		};
+		using Bins = uint32_t[num_channels][256];
+		constexpr static int min_band_rows = 32;
+
+	private:
+		Bins bins{};
+		FrameAllocator band_pool{};
+
+		// the rect the counts are of.
+		Rect area{};
+		bool valid = false;
+		// increments every time the counts change.
+		uint32_t epoch_ = 0;
+
+		// adds the pixels of `rc` to `dst`, or removes them if `sign` is negative.
+		template<int sign>
+		static void count(Bins& dst, const ImageView& src, const Rect& rc)
+		{
+			constexpr auto d = static_cast<uint32_t>(sign);
+			// the lumas are converted in batches ahead of counting.
+			constexpr int batch = 256;
+			byte lumas[batch];
+			for (int y = rc.top; y < rc.bottom; y++) {
+				const byte* s = src.row(y) + 3 * rc.left;
+				for (int x = rc.left; x < rc.right; x += batch) {
+					int const n = std::min(batch, rc.right - x);
+					color_space::color_luma_span(s, lumas, n);
+					for (int i = 0; i < n; i++, s += 3) {
+						dst[blue][s[0]] += d;
+						dst[green][s[1]] += d;
+						dst[red][s[2]] += d;
+						dst[luma][lumas[i]] += d;
+					}
+				}
+			}
+		}
+
+		// calls `f` with each of at most four rects covering `a` minus `b`.
+		static void subtract(const Rect& a, const Rect& b, auto&& f)
+		{
+			auto const c = a & b;
+			if (c.is_empty()) { if (!a.is_empty()) f(a); return; }
+			if (a.top < c.top) f(Rect{ a.left, a.top, a.right, c.top });
+			if (c.bottom < a.bottom) f(Rect{ a.left, c.bottom, a.right, a.bottom });
+			if (a.left < c.left) f(Rect{ a.left, c.top, c.left, c.bottom });
+			if (c.right < a.right) f(Rect{ c.right, c.top, a.right, c.bottom });
+		}
+		static constexpr int64_t size_of(const Rect& rc) {
+			return rc.is_empty() ? 0 : int64_t{ rc.width() } * rc.height();
+		}
+
+		void rebuild(const ImageView& src, const Rect& rc, StripPool* strips)
+		{
+			std::fill_n(&bins[0][0], num_channels * 256, 0u);
+			int const h = rc.is_empty() ? 0 : rc.height();
+			int const num_bands = strips == nullptr ? 1 : std::clamp(h / min_band_rows, 1, strips->threads());
+			auto const local = num_bands > 1 ? static_cast<Bins*>(band_pool.allocate(sizeof(Bins) * num_bands)) : nullptr;
+			if (local == nullptr) {
+				count<+1>(bins, src, rc);
+				return;
+			}
+
+			// each band counts into its own bins so the threads won't contend, and they are summed up afterward.
+			strips->run(num_bands, [&](int b) {
+				auto& dst = local[b];
+				std::fill_n(&dst[0][0], num_channels * 256, 0u);
+				count<+1>(dst, src, { rc.left, rc.top + h * b / num_bands, rc.right, rc.top + h * (b + 1) / num_bands });
+			});
+			for (int b = 0; b < num_bands; b++) {
+				for (int c = 0; c < num_channels; c++)
+					for (int i = 0; i < 256; i++) bins[c][i] += local[b][c][i];
+			}
+		}
+
+	public:
+		// notifies that the `changed` area of the source has been modified,
+		// and that the source holds the valid pixels only within `available`.
+		void invalidate(const Rect& changed, const Rect& available)
+		{
+			if (changed.intersects(area) || !available.contains(area)) valid = false;
+		}
+
+		// makes the counts reflect the pixels of `src` within `rc`.
+		// the source must hold the valid pixels within `rc`, and within the last rect unless invalidated.
+		void update(const ImageView& src, Rect rc, StripPool* strips = nullptr)
+		{
+			rc &= Rect::of_size(src.width, src.height);
+			if (rc.is_empty()) rc = Rect::empty();
+			if (valid && rc == area) return;
+
+			// moving costs the strips leaving and entering, which is cheaper while they overlap more than half.
+			if (valid && 2 * size_of(area & rc) > size_of(area)) {
+				subtract(area, rc, [&](const Rect& r) { count<-1>(bins, src, r); });
+				subtract(rc, area, [&](const Rect& r) { count<+1>(bins, src, r); });
+			}
+			else rebuild(src, rc, strips);
+			area = rc;
+			valid = true;
+			epoch_++;
+		}
+
+		constexpr const Bins& counts() const { return bins; }
+		constexpr const Rect& rect() const { return area; }
+		constexpr uint32_t epoch() const { return epoch_; }
+
+		// draws the counts as bars into `rc` of `dst`, which can be of 32bpp, over the darkened pixels.
+		// each of R, G and B lights its own channel, and the luma is drawn as a white line.
+		void draw(const ImageView& dst, const Rect& rc) const
+		{
+			auto const out = rc & Rect::of_size(dst.width, dst.height);
+			if (out.is_empty()) return;
+			int const w = rc.width(), h = rc.height();
+
+			// the tallest bin fills the height.
+			uint32_t peak = 1;
+			for (auto const& ch : bins) peak = std::max(peak, *std::max_element(std::begin(ch), std::end(ch)));
+
+			for (int x = out.left; x < out.right; x++) {
+				// the bins this column covers, taking the largest.
+				int const i0 = 256 * (x - rc.left) / w, i1 = std::max(i0 + 1, 256 * (x + 1 - rc.left) / w);
+				int heights[num_channels];
+				for (int c = 0; c < num_channels; c++) {
+					uint64_t const v = *std::max_element(bins[c] + i0, bins[c] + i1);
+					// non-zero counts are at least one pixel tall.
+					heights[c] = static_cast<int>((v * h + peak - 1) / peak);
+				}
+
+				for (int y = out.top; y < out.bottom; y++) {
+					byte* const p = dst.row(y) + dst.depth * x;
+					int const k = rc.bottom - 1 - y;
+					if (k + 1 == heights[luma]) p[0] = p[1] = p[2] = 255;
+					else for (int c = 0; c < 3; c++) p[c] = k < heights[c] ? 255 : p[c] >> 2;
+				}
+			}
+		}
+
+		void release()
+		{
+			band_pool.release();
+			area = Rect::empty();
+			valid = false;
+		}
+	};
+}
@@ -0,0 +1,96 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+// SIMD 命令セットの判定．
+#if defined(__AVX2__)
+#define SIGMA_LIB_IMAGE_AVX2	1
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIGMA_LIB_IMAGE_SSE2	1
+#include <emmintrin.h>
+#endif
+
+////////////////////////////////
+// 画像処理の共通定義．
+////////////////////////////////
+namespace sigma_lib::image
+{
+	using byte = uint8_t;
+
+	// rectangle in pixels, left/top inclusive, right/bottom exclusive.
+	// the layout is the same as Win32 RECT so they can be bit-casted each other.
+	struct Rect {
+		int32_t left, top, right, bottom;
+
+		constexpr int width() const { return right - left; }
+		constexpr int height() const { return bottom - top; }
+		constexpr bool is_empty() const { return left >= right || top >= bottom; }
+
+		constexpr bool contains(int x, int y) const {
+			return left <= x && x < right && top <= y && y < bottom;
+		}
+		constexpr bool contains(const Rect& rc) const {
+			return rc.is_empty() || (left <= rc.left && rc.right <= right && top <= rc.top && rc.bottom <= bottom);
+		}
+		constexpr bool intersects(const Rect& rc) const {
+			return !is_empty() && !rc.is_empty() &&
+				left < rc.right && rc.left < right && top < rc.bottom && rc.top < bottom;
+		}
+
+		// the intersection. the result might be empty.
+		constexpr Rect operator&(const Rect& rc) const {
+			return { std::max(left, rc.left), std::max(top, rc.top), std::min(right, rc.right), std::min(bottom, rc.bottom) };
+		}
+		// the smallest rect that contains both.
+		constexpr Rect operator|(const Rect& rc) const {
+			if (is_empty()) return rc;
+			if (rc.is_empty()) return *this;
+			return { std::min(left, rc.left), std::min(top, rc.top), std::max(right, rc.right), std::max(bottom, rc.bottom) };
+		}
+		constexpr Rect& operator&=(const Rect& rc) { return *this = *this & rc; }
+		constexpr Rect& operator|=(const Rect& rc) { return *this = *this | rc; }
+		constexpr bool operator==(const Rect&) const = default;
+
+		// inflates each sides by the specified amount.
+		constexpr Rect inflate(int dx, int dy) const { return { left - dx, top - dy, right + dx, bottom + dy }; }
+		constexpr Rect offset(int dx, int dy) const { return { left + dx, top + dy, right + dx, bottom + dy }; }
+
+		constexpr static Rect empty() { return { 0, 0, 0, 0 }; }
+		constexpr static Rect of_size(int w, int h) { return { 0, 0, w, h }; }
+	};
+
+	// a 24bpp image stored bottom-up as in DIB.
+	// the drawings onto the window also accept 32bpp images of B, G, R and an unused byte,
+	// which are marked by `depth` of 4.
+	struct ImageView {
+		byte* bits;
+		int width, height;
+		size_t stride;
+		int depth = 3; // bytes per pixel.
+
+		// returns the pointer to the row `y` counted from the top.
+		constexpr byte* row(int y) const { return bits + (height - 1 - y) * stride; }
+
+		static constexpr size_t stride_of(int width, int depth = 3) {
+			// rounding upward into a multiple of 4.
+			return (depth * width + 3) & (-4);
+		}
+	};
+}
@@ -0,0 +1,213 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#include "image_basics.hpp"
+#include "image_ingest.hpp"
+#include "frame_alloc.hpp"
+#include "frame_borrow.hpp"
+
+////////////////////////////////
+// 画像バッファ．
+////////////////////////////////
+namespace sigma_lib::image
+{
+	// holds the image the loupe shows, as a 24bpp bottom-up copy of the frame,
+	// or as the frame borrowed from the host while it's valid.
+	class ImageBuffer {
+		// keeps the capacity so switching between sizes won't re-commit pages.
+		FrameAllocator pool{};
+		void* buf = nullptr;
+		int wd = 0, ht = 0;
+		Rect dirty{}, cached{};
+		bool stale = true;
+
+		// the frame lent from AviUtl, instead of the copy in `buf`.
+		FrameBorrow borrow{};
+		FrameBorrow::Ticket ticket{};
+
+		// returns false if the memory couldn't be allocated, leaving the image empty.
+		bool reallocate(int w, int h)
+		{
+			wd = w; ht = h;
+			buf = pool.allocate(stride() * ht);
+			if (buf == nullptr) {
+				wd = ht = 0;
+				cached = dirty = Rect::empty();
+				return false;
+			}
+			return true;
+		}
+		// lets the pool release its excess capacity after a while.
+		void tick_pool()
+		{
+			pool.tick();
+			buf = pool.data();
+		}
+
+	public:
+		// same as CLR_INVALID.
+		constexpr static uint32_t invalid_color = 0xffffffff;
+
+		// the pixels of the image; the borrowed frame while it's available, or the private copy.
+		constexpr const void* buffer() const {
+			if (auto frame = borrow.get(ticket)) return frame;
+			return buf;
+		}
+		constexpr auto width() const { return wd; }
+		constexpr auto height() const { return ht; }
+
+		static constexpr int stride(int width) {
+			// rounding upward into a multiple of 4.
+			return (3 * width + 3) & (-4);
+		}
+		constexpr int stride() const { return stride(width()); }
+
+		// the color at the pixel in COLORREF, or `invalid_color` if out of the image.
+		uint32_t color_at(int x, int y) const
+		{
+			if (buf == nullptr ||
+				x < 0 || y < 0 || x >= wd || y >= ht) return invalid_color;
+			auto ptr = reinterpret_cast<const byte*>(buffer()) + 3 * x + stride() * (ht - 1 - y);
+			return ptr[2] | (ptr[1] << 8) | (ptr[0] << 16);
+		}
+
+		// returns true if the image size has been changed.
+		// only the `region` of the image is taken in, and the rest is left for ensure().
+		bool update(int w, int h, const void* source, Rect region)
+		{
+			borrow.close();
+
+			// check for size changes to the image.
+			if (wd != w || ht != h)
+			{
+				if (!reallocate(w, h)) return true;
+				std::memcpy(buf, source, stride() * ht);
+				cached = dirty = Rect::of_size(w, h);
+				stale = false;
+				return true;
+			}
+			tick_pool();
+
+			// copy only the rows that differ from the current.
+			region &= Rect::of_size(w, h);
+			dirty = ingest::diff_copy(buf, source, region, h, stride(), 3);
+			cached = region;
+			if (stale) {
+				dirty = Rect::of_size(w, h);
+				stale = false;
+			}
+			return false;
+		}
+		bool update(int w, int h, const void* source) { return update(w, h, source, Rect::of_size(w, h)); }
+
+		// borrows the `source` instead of copying it, until close_borrow() is called.
+		// returns true if the image size has been changed.
+		bool update_borrowed(int w, int h, const void* source)
+		{
+			bool size_changed = wd != w || ht != h;
+			if (size_changed) {
+				// nothing to fall back on once the borrow ends.
+				if (!reallocate(w, h)) return true;
+			}
+			else tick_pool();
+
+			// the private copy is of an older frame from now on.
+			ticket = borrow.lend(source);
+			cached = Rect::empty();
+			dirty = Rect::of_size(w, h);
+			stale = false;
+			return size_changed;
+		}
+		// ends the borrow window. the pixels will be copied on demand by ensure() afterwards.
+		void close_borrow() { borrow.close(); }
+
+		// makes sure the `area` of the image holds the current frame, copying from the source otherwise.
+		// `fetch(w, h)` is called only when necessary, and should return the frame of that size, or nullptr.
+		// returns false if the area couldn't be prepared.
+		bool ensure(Rect area, int margin, auto&& fetch)
+		{
+			if (borrow.get(ticket) != nullptr) return true;
+			if (buf == nullptr) return false;
+
+			auto const whole = Rect::of_size(wd, ht);
+			area &= whole;
+			if (cached.contains(area)) return true;
+
+			auto source = fetch(wd, ht);
+			if (source == nullptr) return false;
+
+			// extend the cached area so small moves of the view won't fetch again.
+			area = area.inflate(margin, margin) & whole;
+			if (!cached.intersects(area)) {
+				// too far from the cached area to be joined.
+				ingest::copy(buf, source, area, ht, stride(), 3);
+				cached = area;
+				return true;
+			}
+
+			// copy only the part of the bounding box that isn't cached yet.
+			auto const box = cached | area;
+			Rect const parts[] = {
+				{ box.left, box.top, box.right, cached.top },
+				{ box.left, cached.bottom, box.right, box.bottom },
+				{ box.left, cached.top, cached.left, cached.bottom },
+				{ cached.right, cached.top, box.right, cached.bottom },
+			};
+			for (auto const& part : parts)
+				ingest::copy(buf, source, part, ht, stride(), 3);
+			cached = box;
+			return true;
+		}
+
+		// the area of the image that was changed by the last call to update().
+		constexpr const Rect& dirty_rect() const { return dirty; }
+		// the area of the image that holds the current frame.
+		constexpr const Rect& cached_rect() const { return cached; }
+		// same as cached_rect(), but the entire image while the frame is borrowed.
+		Rect current_rect() const { return borrow.get(ticket) != nullptr ? Rect::of_size(wd, ht) : cached; }
+		// makes the next update() report the entire image as changed,
+		// for when the loupe has been drawn something other than the image.
+		void invalidate() { stale = true; }
+
+		void free()
+		{
+			borrow.close();
+			if (buf != nullptr) {
+				pool.release(), buf = nullptr;
+				wd = ht = 0;
+				cached = Rect::empty();
+			}
+		}
+
+		bool is_valid() const { return buf != nullptr; }
+
+		// releases the excess capacity kept for larger frames, for when the frames have stopped coming.
+		void trim()
+		{
+			if (buf == nullptr) return;
+			pool.trim();
+			buf = pool.data();
+		}
+
+		void use_large_pages(bool large) { pool.set_large_pages(large); }
+		// live/peak bytes of the memory for the image.
+		FrameAllocator::Stats memory_stats() const { return pool.stats(); }
+	};
+}
@@ -0,0 +1,120 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <bit>
+
+#include "image_basics.hpp"
+
+////////////////////////////////
+// 差分行のみを取り込む画像コピー．
+////////////////////////////////
+namespace sigma_lib::image::ingest
+{
+	namespace details
+	{
+		// returns the index of the first differing byte, or `len` if identical.
+		inline size_t first_diff(const byte* a, const byte* b, size_t len)
+		{
+			size_t i = 0;
+		#ifdef SIGMA_LIB_IMAGE_SSE2
+			for (; i + 16 <= len; i += 16) {
+				auto eq = _mm_cmpeq_epi8(
+					_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)),
+					_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+				if (uint32_t mask = ~_mm_movemask_epi8(eq) & 0xffff; mask != 0)
+					return i + std::countr_zero(mask);
+			}
+		#else
+			for (; i + 8 <= len; i += 8) {
+				uint64_t x, y;
+				std::memcpy(&x, a + i, 8); std::memcpy(&y, b + i, 8);
+				if (x != y) break;
+			}
+		#endif
+			for (; i < len; i++) if (a[i] != b[i]) return i;
+			return len;
+		}
+
+		// returns one past the index of the last differing byte, or 0 if identical.
+		inline size_t last_diff(const byte* a, const byte* b, size_t len)
+		{
+			size_t i = len;
+		#ifdef SIGMA_LIB_IMAGE_SSE2
+			for (; i >= 16; i -= 16) {
+				auto eq = _mm_cmpeq_epi8(
+					_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i - 16)),
+					_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i - 16)));
+				if (uint32_t mask = ~_mm_movemask_epi8(eq) & 0xffff; mask != 0)
+					return i - std::countl_zero(mask << 16);
+			}
+		#else
+			for (; i >= 8; i -= 8) {
+				uint64_t x, y;
+				std::memcpy(&x, a + i - 8, 8); std::memcpy(&y, b + i - 8, 8);
+				if (x != y) break;
+			}
+		#endif
+			for (; i > 0; i--) if (a[i - 1] != b[i - 1]) return i;
+			return 0;
+		}
+	}
+
+	// copies the image from `src` to `dst`, only the spans of rows that differ,
+	// limited to the `region`, and returns the changed area. both images are of the identical layout;
+	// `height` rows of `stride` bytes each, stored bottom-up as in DIB, and each pixel consists of `bpp` bytes.
+	// `region` and the returned rect are in top-down coordinates, and `region` must be inside the image.
+	inline Rect diff_copy(void* dst, const void* src, const Rect& region, int height, size_t stride, int bpp)
+	{
+		auto const d = static_cast<byte*>(dst) + static_cast<size_t>(region.left) * bpp;
+		auto const s = static_cast<const byte*>(src) + static_cast<size_t>(region.left) * bpp;
+		size_t const row_len = static_cast<size_t>(region.width()) * bpp;
+
+		Rect dirty = Rect::empty();
+		if (region.is_empty()) return dirty;
+		for (int r = height - region.bottom; r < height - region.top; r++) {
+			auto const dr = d + r * stride;
+			auto const sr = s + r * stride;
+
+			size_t const l = details::first_diff(dr, sr, row_len);
+			if (l == row_len) continue;
+			size_t const e = l + details::last_diff(dr + l, sr + l, row_len - l);
+
+			std::memcpy(dr + l, sr + l, e - l);
+
+			int const y = height - 1 - r;
+			dirty |= {
+				region.left + static_cast<int>(l / bpp), y,
+				region.left + static_cast<int>((e + bpp - 1) / bpp), y + 1 };
+		}
+		return dirty;
+	}
+	inline Rect diff_copy(void* dst, const void* src, int width, int height, size_t stride, int bpp) {
+		return diff_copy(dst, src, Rect::of_size(width, height), height, stride, bpp);
+	}
+
+	// plainly copies the `region` of the image from `src` to `dst`. the layout is the same as diff_copy().
+	inline void copy(void* dst, const void* src, const Rect& region, int height, size_t stride, int bpp)
+	{
+		if (region.is_empty()) return;
+		size_t const offset = (height - region.bottom) * stride + static_cast<size_t>(region.left) * bpp;
+		auto d = static_cast<byte*>(dst) + offset;
+		auto s = static_cast<const byte*>(src) + offset;
+		size_t const row_len = static_cast<size_t>(region.width()) * bpp;
+		for (int i = region.height(); --i >= 0; d += stride, s += stride)
+			std::memcpy(d, s, row_len);
+	}
+}
@@ -0,0 +1,191 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+#pragma once
+
+#include <cmath>
+#include <algorithm>
+#include <utility>
+
+#include "image_basics.hpp"
+#include "canvas.hpp"
+#include "mipmap.hpp"
+#include "upscale.hpp"
+
+////////////////////////////////
+// 拡大率と表示範囲の計算．
+////////////////////////////////
+namespace sigma_lib::image
+{
+	// zoom --- manages the scaling ratio of zooming.
+	struct LoupeZoom {
+		int zoom_level, second_level;
+		constexpr static int zoom_level_min = -17, zoom_level_max = 24;
+
+	private:
+		constexpr static int scale_denominator = 4;
+		static constexpr int scale_base(int level) {
+			return (4 + (level & 3)) << (level >> 2);
+		}
+	public:
+		static constexpr double scale_ratio(int scale_level) { return scale_level >= 0 ? scale_level == 0 ? 1 : upscale(scale_level) : 1 / downscale(scale_level); }
+		static constexpr double scale_ratio_inv(int scale_level) { return scale_level >= 0 ? scale_level == 0 ? 1 : 1 / upscale(scale_level) : downscale(scale_level); }
+		static constexpr auto scale_ratios(int scale_level) {
+			double s;
+			return scale_level >= 0 ? scale_level == 0 ? std::make_pair(1.0, 1.0) :
+				((s = upscale(scale_level)), std::make_pair(s, 1 / s)) :
+				((s=downscale(scale_level)), std::make_pair(1 / s, s));
+		}
+		static constexpr auto scale_ratio_Q(int zoom_level)
+		{
+			int n = scale_denominator, d = scale_denominator;
+			if (zoom_level < 0) d = scale_base(-zoom_level);
+			else n = scale_base(zoom_level);
+			// as of either the numerator or the denominator is a power of 2, so is the GCD.
+			auto gcd = n | d; gcd &= -gcd; // = std::gcd(n, d);
+			return std::make_pair(n / gcd, d / gcd);
+		}
+		static constexpr double upscale(int zoom_level) { return (1.0 / scale_denominator) * scale_base(zoom_level); }
+		static constexpr double downscale(int zoom_level) { return upscale(-zoom_level); }
+
+		constexpr double scale_ratio() const { return scale_ratio(zoom_level); }
+		constexpr double scale_ratio_inv() const { return scale_ratio_inv(zoom_level); }
+		constexpr auto scale_ratios() const { return scale_ratios(zoom_level); }
+		constexpr auto scale_ratio_Q() const { return scale_ratio_Q(zoom_level); }
+	};
+
+	// returns the pair of "view box" and "view port" for the picture position (`x`, `y`)
+	// displayed at the center of the client area.
+	// view box: the area of the picture to be on-screen.
+	// view port: the area of the window where the picture will be on.
+	// those are rounded so view box covers the entire pixels to be on-screen,
+	// and view port may cover beyond the window corners.
+	inline std::pair<Rect, Rect> viewbox_viewport(const LoupeZoom& zoom, double x, double y,
+		int picture_w, int picture_h, int client_w, int client_h)
+	{
+		auto const [s1, s2] = zoom.scale_ratios();
+		auto const p2w = [&](double u, double v) { return std::make_pair(s1 * (u - x), s1 * (v - y)); };
+		auto const w2p = [&](double u, double v) { return std::make_pair(s2 * u + x, s2 * v + y); };
+
+		auto [pl, pt] = w2p(-0.5 * client_w, -0.5 * client_h);
+		auto [pr, pb] = w2p(+0.5 * client_w, +0.5 * client_h);
+		pl = std::max<double>(std::floor(pl), 0);
+		pt = std::max<double>(std::floor(pt), 0);
+		pr = std::min<double>(std::ceil(pr), picture_w);
+		pb = std::min<double>(std::ceil(pb), picture_h);
+
+		auto [wl, wt] = p2w(pl, pt);
+		auto [wr, wb] = p2w(pr, pb);
+		wl = std::floor(0.5 + wl + 0.5 * client_w);
+		wt = std::floor(0.5 + wt + 0.5 * client_h);
+		wr = std::floor(0.5 + wr + 0.5 * client_w);
+		wb = std::floor(0.5 + wb + 0.5 * client_h);
+
+		constexpr auto i = [](double v) { return static_cast<int>(v); };
+		return {
+			{ i(pl), i(pt), i(pr), i(pb) },
+			{ i(wl), i(wt), i(wr), i(wb) },
+		};
+	}
+
+	// at the integer scale `n`, the part of the view box and port that covers the `area` of the window,
+	// rounded outward to whole pixels of the picture. the view box is empty if nothing is there.
+	constexpr std::pair<Rect, Rect> sub_viewbox_viewport(const Rect& area, const Rect& vb, const Rect& vp, int n)
+	{
+		constexpr auto floor_div = [](int x, int n) { return x >= 0 ? x / n : -((n - 1 - x) / n); };
+		// the position of the top-left corner of the picture on the screen.
+		int const ox = vp.left - n * vb.left, oy = vp.top - n * vb.top;
+		Rect const sub_vb{
+			std::max<int>(vb.left, floor_div(area.left - ox, n)),
+			std::max<int>(vb.top, floor_div(area.top - oy, n)),
+			std::min<int>(vb.right, floor_div(area.right - ox + n - 1, n)),
+			std::min<int>(vb.bottom, floor_div(area.bottom - oy + n - 1, n)),
+		};
+		return { sub_vb, {
+			ox + n * sub_vb.left, oy + n * sub_vb.top,
+			ox + n * sub_vb.right, oy + n * sub_vb.bottom,
+		} };
+	}
+
+	// at the integer scale `n`, the amount the picture moved on the screen from the previous view box and port.
+	constexpr std::pair<int, int> scroll_offset(const Rect& prev_vb, const Rect& prev_vp, const Rect& vb, const Rect& vp, int n)
+	{
+		return { (vp.left - n * vb.left) - (prev_vp.left - n * prev_vb.left),
+			(vp.top - n * vb.top) - (prev_vp.top - n * prev_vb.top) };
+	}
+
+	// the strips of the `width` x `height` window exposed by scrolling by (`dx`, `dy`),
+	// the vertical one first. either can be empty.
+	constexpr std::pair<Rect, Rect> exposed_strips(int dx, int dy, int width, int height)
+	{
+		return {
+			dx == 0 ? Rect::empty() : dx > 0 ? Rect{ 0, 0, dx, height } : Rect{ width + dx, 0, width, height },
+			dy == 0 ? Rect::empty() : dy > 0 ? Rect{ 0, 0, width, dy } : Rect{ 0, height + dy, width, height },
+		};
+	}
+}
+
+////////////////////////////////
+// 背景と画像の描画．
+////////////////////////////////
+namespace sigma_lib::image
+{
+	// the pixels to draw as the picture, with the position of their top-left corner in the image.
+	struct Picture {
+		ImageView view;
+		int left = 0, top = 0;
+
+		// the view box in the coordinate of `view`.
+		constexpr Rect source(const Rect& vb) const { return vb.offset(-left, -top); }
+	};
+
+	// 背景描画．
+	inline void draw_backplane(Canvas& canvas, const Rect& rc, uint32_t blank)
+	{
+		canvas.fill_rect(rc, blank);
+	}
+
+	// 画像描画．draws the `vb` area of the picture onto `vp`,
+	// or from the level of `mipmap` when `mip_level` is positive, which has to be prepared for `vb`.
+	inline void draw_picture(Canvas& canvas, const Picture& pic, const Rect& vb, const Rect& vp,
+		const MipPyramid& mipmap, int mip_level)
+	{
+		if (mip_level > 0 && !vb.is_empty()) {
+			// draw from the reduced image. the source rect is rounded outward,
+			// so the destination is extended accordingly.
+			auto const& lv = mipmap.level(mip_level);
+			auto const rc = MipPyramid::reduce(vb, mip_level);
+			double const sx = static_cast<double>(vp.width()) / vb.width(),
+				sy = static_cast<double>(vp.height()) / vb.height();
+			auto const X = [&](int x) { return vp.left + static_cast<int>(std::round(sx * ((x << mip_level) - vb.left))); };
+			auto const Y = [&](int y) { return vp.top + static_cast<int>(std::round(sy * ((y << mip_level) - vb.top))); };
+
+			canvas.stretch_image({ X(rc.left), Y(rc.top), X(rc.right), Y(rc.bottom) }, lv, rc);
+			return;
+		}
+
+		canvas.stretch_image(vp, pic.view, pic.source(vb));
+	}
+
+	// 画像描画 (software upscaling)．draws only the part within `rc` of the window.
+	inline void draw_picture_upscaled(Canvas& canvas, Upscaler& upscaler, const Picture& pic,
+		const Rect& rc, const Rect& vb, const Rect& vp, StripPool* strips)
+	{
+		auto const& out = upscaler.render(pic.view, pic.source(vb), vp, rc, strips);
+		if (out.width <= 0) return;
+
+		canvas.draw_image(std::max(vp.left, rc.left), std::max(vp.top, rc.top), out);
+	}
+}
@@ -0,0 +1,265 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+
+
+
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <charconv>
+#include <string_view>
+#include <algorithm>
+
+#include "image_basics.hpp"
+#include "frame_alloc.hpp"
+
+////////////////////////////////
+// 3D LUT による色変換．
+////////////////////////////////
+namespace sigma_lib::image
+{
+	// a 3D LUT read from a .cube file, applied to the pixels by the tetrahedral interpolation.
+	class Lut3D {
+	public:
+		// the range of LUT_3D_SIZE accepted. 17, 33 and 65 are the common ones.
+		constexpr static int points_min = 2, points_max = 65;
+
+	private:
+		// the lattice points in B, G, R and a padding, in the unit of 1/64 levels, red varying fastest.
+		FrameAllocator table_pool{}, out_pool{};
+		int16_t(*table)[4] = nullptr;
+		int points = 0;
+
+		// for each input level of a channel, the offset of the lattice cell
+		// and the weight of its upper end in the unit of 1/4096.
+		constexpr static int weight_one = 1 << 12;
+		struct Axis {
+			uint32_t offset[256];
+			int16_t weight[256];
+		} axes[3]{}; // in B, G, R.
+
+		ImageView out{};
+		Rect valid{};
+
+		// the channels in B, G, R = 0, 1, 2 in descending order of the fractions,
+		// for the index of `(fr >= fg) << 2 | (fg >= fb) << 1 | (fr >= fb)`.
+		// either order of ties gives the same result, and the impossible combinations are filled arbitrarily.
+		constexpr static uint8_t tetrahedra[8][3] = {
+			{ 0, 1, 2 }, { 0, 1, 2 }, { 1, 0, 2 }, { 1, 2, 0 },
+			{ 0, 2, 1 }, { 2, 0, 1 }, { 0, 1, 2 }, { 2, 1, 0 },
+		};
+
+		// reads up to `n` floats separated by spaces. returns the number read.
+		static int read_floats(const char*& p, const char* end, float* v, int n)
+		{
+			int i = 0;
+			for (; i < n; i++) {
+				while (p < end && (*p == ' ' || *p == '\t')) p++;
+				auto const [q, ec] = std::from_chars(p, end, v[i]);
+				if (ec != std::errc{}) break;
+				p = q;
+			}
+			return i;
+		}
+
+		// prepares `axes` for the domain of the input in R, G, B.
+		void setup_axes(const float(&dom_min)[3], const float(&dom_max)[3])
+		{
+			uint32_t const strides[3] = { uint32_t(points) * points, uint32_t(points), 1 };
+			for (int c = 0; c < 3; c++) {
+				float const lo = dom_min[2 - c], span = dom_max[2 - c] - lo;
+				for (int v = 0; v < 256; v++) {
+					float x = span > 0 ? (v / 255.0f - lo) / span : 0;
+					x = std::clamp(x, 0.0f, 1.0f) * (points - 1);
+					int const i = std::min(static_cast<int>(x), points - 2);
+					axes[c].offset[v] = i * strides[c];
+					axes[c].weight[v] = static_cast<int16_t>(std::lround((x - i) * weight_one));
+				}
+			}
+		}
+
+		// maps a pixel of B, G, R at `src` into `dst`.
+		void map_pixel(const byte* src, byte* dst) const
+		{
+			auto const& ab = axes[0], & ag = axes[1], & ar = axes[2];
+			uint32_t const base = ab.offset[src[0]] + ag.offset[src[1]] + ar.offset[src[2]];
+			int const f[3] = { ab.weight[src[0]], ag.weight[src[1]], ar.weight[src[2]] };
+			uint32_t const s[3] = { uint32_t(points) * points, uint32_t(points), 1 };
+
+			// the order of the fractions in descending order chooses the tetrahedron.
+			// it's looked up from the comparisons rather than sorted, as branches mispredict on noisy pictures.
+			auto const& o = tetrahedra[(f[2] >= f[1]) << 2 | (f[1] >= f[0]) << 1 | (f[2] >= f[0])];
+			int const f0 = f[o[0]], f1 = f[o[1]], f2 = f[o[2]];
+			auto const c0 = table[base], c1 = table[base + s[o[0]]],
+				c2 = table[base + s[o[0]] + s[o[1]]], c3 = table[base + s[o[0]] + s[o[1]] + s[o[2]]];
+			int const w0 = weight_one - f0, w1 = f0 - f1, w2 = f1 - f2, w3 = f2;
+
+			// the sums are in the unit of 1/(64 * 4096) levels.
+			constexpr int shift = 6 + 12;
+		#ifdef SIGMA_LIB_IMAGE_SSE2
+			auto const lo = _mm_unpacklo_epi16(
+				_mm_loadl_epi64(reinterpret_cast<const __m128i*>(c0)),
+				_mm_loadl_epi64(reinterpret_cast<const __m128i*>(c1)));
+			auto const hi = _mm_unpacklo_epi16(
+				_mm_loadl_epi64(reinterpret_cast<const __m128i*>(c2)),
+				_mm_loadl_epi64(reinterpret_cast<const __m128i*>(c3)));
+			auto sum = _mm_add_epi32(
+				_mm_madd_epi16(lo, _mm_set1_epi32((w1 << 16) | w0)),
+				_mm_madd_epi16(hi, _mm_set1_epi32((w3 << 16) | w2)));
+			sum = _mm_srai_epi32(_mm_add_epi32(sum, _mm_set1_epi32(1 << (shift - 1))), shift);
+			sum = _mm_packs_epi32(sum, sum);
+			uint32_t const bgr = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_packus_epi16(sum, sum)));
+			dst[0] = static_cast<byte>(bgr);
+			dst[1] = static_cast<byte>(bgr >> 8);
+			dst[2] = static_cast<byte>(bgr >> 16);
+		#else
+			for (int i = 0; i < 3; i++) {
+				int const v = (c0[i] * w0 + c1[i] * w1 + c2[i] * w2 + c3[i] * w3 + (1 << (shift - 1))) >> shift;
+				dst[i] = static_cast<byte>(std::clamp(v, 0, 255));
+			}
+		#endif
+		}
+
+		// maps the pixels from `x0` to `x1` of a row.
+		void map_row(const byte* src, byte* dst, int x0, int x1) const
+		{
+			for (int x = x0; x < x1; x++) map_pixel(src + 3 * x, dst + 3 * x);
+		}
+
+	public:
+		// parses the text of a .cube file. returns false if it isn't a valid 3D LUT,
+		// in which case the LUT becomes unloaded.
+		bool load(const char* text, size_t len)
+		{
+			release();
+			float dom_min[3] = { 0, 0, 0 }, dom_max[3] = { 1, 1, 1 };
+			size_t count = 0, total = 0;
+
+			for (const char* p = text, * const end = text + len; p < end; ) {
+				const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+				if (eol == nullptr) eol = end;
+				const char* q = p;
+				p = eol + 1;
+
+				while (q < eol && (*q == ' ' || *q == '\t' || *q == '\r')) q++;
+				if (q == eol || *q == '#') continue;
+
+				auto const keyword = [&](std::string_view key) {
+					if (static_cast<size_t>(eol - q) <= key.size() || std::memcmp(q, key.data(), key.size()) != 0 ||
+						(q[key.size()] != ' ' && q[key.size()] != '\t')) return false;
+					q += key.size();
+					return true;
+				};
+				if (('0' <= *q && *q <= '9') || *q == '-' || *q == '+' || *q == '.') {
+					float v[3];
+					if (table == nullptr || count >= total || read_floats(q, eol, v, 3) < 3) break;
+					for (int i = 0; i < 3; i++) // stored in B, G, R.
+						table[count][2 - i] = static_cast<int16_t>(std::lround(std::clamp(v[i], 0.0f, 1.0f) * (255 * 64)));
+					table[count][3] = 0;
+					count++;
+				}
+				else if (keyword("LUT_3D_SIZE")) {
+					int n = 0;
+					while (q < eol && (*q == ' ' || *q == '\t')) q++;
+					std::from_chars(q, eol, n);
+					if (table != nullptr || n < points_min || n > points_max) break;
+					points = n;
+					total = size_t(n) * n * n;
+					table = static_cast<int16_t(*)[4]>(table_pool.allocate(total * sizeof(*table)));
+					if (table == nullptr) break;
+				}
+				else if (keyword("DOMAIN_MIN")) {
+					if (read_floats(q, eol, dom_min, 3) < 3) break;
+				}
+				else if (keyword("DOMAIN_MAX")) {
+					if (read_floats(q, eol, dom_max, 3) < 3) break;
+				}
+				else if (keyword("LUT_3D_INPUT_RANGE")) {
+					float range[2];
+					if (read_floats(q, eol, range, 2) < 2) break;
+					std::fill_n(dom_min, 3, range[0]);
+					std::fill_n(dom_max, 3, range[1]);
+				}
+				else if (keyword("LUT_1D_SIZE")) break;
+				// other keywords such as TITLE are ignored.
+			}
+
+			if (table == nullptr || count != total) {
+				release();
+				return false;
+			}
+			setup_axes(dom_min, dom_max);
+			return true;
+		}
+		constexpr bool is_loaded() const { return table != nullptr; }
+
+		// the color of the pixel of B, G, R at `src` through the LUT, into `dst`.
+		void map(const byte* src, byte* dst) const
+		{
+			if (is_loaded()) map_pixel(src, dst);
+			else std::memcpy(dst, src, 3);
+		}
+
+		// drops the results of render() where the source pixels have changed.
+		constexpr void invalidate(const Rect& changed)
+		{
+			if (changed.intersects(valid)) valid = Rect::empty();
+		}
+
+		// applies the LUT to the pixels of `src` within `rc` into output().
+		// only the pixels not converted yet are processed.
+		const ImageView& render(const ImageView& src, Rect rc)
+		{
+			if (!is_loaded()) return out;
+			if (out.width != src.width || out.height != src.height || out.bits == nullptr) {
+				auto const stride = ImageView::stride_of(src.width);
+				out = { static_cast<byte*>(out_pool.allocate(stride * src.height)), src.width, src.height, stride };
+				valid = Rect::empty();
+				if (out.bits == nullptr) { out = {}; return out; }
+			}
+
+			rc &= Rect::of_size(src.width, src.height);
+			if (rc.is_empty() || valid.contains(rc)) return out;
+			auto const known = rc & valid;
+			for (int y = rc.top; y < rc.bottom; y++) {
+				int x0 = rc.left, x1 = rc.left;
+				if (!known.is_empty() && known.top <= y && y < known.bottom) {
+					x0 = known.left; x1 = known.right;
+				}
+				map_row(src.row(y), out.row(y), rc.left, x0);
+				map_row(src.row(y), out.row(y), x1, rc.right);
+			}
+			valid = rc;
+			return out;
+		}
+
+		// the pixels converted by the last render(), of the same size as the source.
+		constexpr const ImageView& output() const { return out; }
+
+		void release()
+		{
+			table_pool.release();
+			out_pool.release();
+			table = nullptr;
+			points = 0;
+			out = {};
+			valid = Rect::empty();
+		}
+	};
+}
@@ -0,0 +1,156 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+
+#include "image_basics.hpp"
+#include "frame_alloc.hpp"
+
+////////////////////////////////
+// 縮小表示用のミップマップ．
+////////////////////////////////
+namespace sigma_lib::image
+{
+	// pyramid of box-filtered images, each level half the size of the previous.
+	// level 0 is the source image itself, and isn't held by this class.
+	// levels are built only for the requested area, and updated incrementally for the changed area.
+	class MipPyramid {
+	public:
+		constexpr static int max_levels = 4;
+
+	private:
+		FrameAllocator pools[max_levels];
+		ImageView levels[max_levels + 1]{};
+
+		// the area where every level reflects the source, in the coordinate of level 0.
+		Rect valid{};
+		// the area of the source changed since the last build.
+		Rect dirty{};
+
+		void reallocate(int w, int h)
+		{
+			levels[0] = { nullptr, w, h, ImageView::stride_of(w) };
+			for (int k = 1; k <= max_levels; k++) {
+				w = (w + 1) >> 1; h = (h + 1) >> 1;
+				auto const stride = ImageView::stride_of(w);
+				levels[k] = { static_cast<byte*>(pools[k - 1].allocate(stride * h)), w, h, stride };
+			}
+		}
+
+		// averages 2x2 pixels of `src` into the pixels of `dst` within `rc`, in the coordinate of `dst`.
+		static void reduce_half(const ImageView& src, const ImageView& dst, const Rect& rc)
+		{
+			int const x_last = src.width - 1, y_last = src.height - 1;
+			for (int y = rc.top; y < rc.bottom; y++) {
+				const byte* const r0 = src.row(2 * y);
+				const byte* const r1 = src.row(std::min(2 * y + 1, y_last));
+				byte* d = dst.row(y) + 3 * rc.left;
+
+				int x = rc.left;
+				// the pixels whose 2x2 neighbors are all inside the source.
+				for (int x_end = std::min(rc.right, src.width >> 1); x < x_end; x++, d += 3) {
+					auto const p0 = r0 + 6 * x, p1 = r1 + 6 * x;
+					d[0] = static_cast<byte>((p0[0] + p0[3] + p1[0] + p1[3] + 2) >> 2);
+					d[1] = static_cast<byte>((p0[1] + p0[4] + p1[1] + p1[4] + 2) >> 2);
+					d[2] = static_cast<byte>((p0[2] + p0[5] + p1[2] + p1[5] + 2) >> 2);
+				}
+				// the rightmost column of an odd width, duplicating the edge.
+				for (; x < rc.right; x++, d += 3) {
+					auto const p0 = r0 + 3 * std::min(2 * x, x_last), p1 = r1 + 3 * std::min(2 * x, x_last);
+					d[0] = static_cast<byte>((p0[0] + p1[0] + 1) >> 1);
+					d[1] = static_cast<byte>((p0[1] + p1[1] + 1) >> 1);
+					d[2] = static_cast<byte>((p0[2] + p1[2] + 1) >> 1);
+				}
+			}
+		}
+
+		void build(const Rect& area)
+		{
+			Rect rc = area;
+			for (int k = 1; k <= max_levels; k++) {
+				rc = reduce(rc, 1) & Rect::of_size(levels[k].width, levels[k].height);
+				if (rc.is_empty()) break;
+				reduce_half(levels[k - 1], levels[k], rc);
+			}
+		}
+
+	public:
+		// converts the rect into that of the level `k`, covering the original.
+		static constexpr Rect reduce(const Rect& rc, int k) {
+			int const m = (1 << k) - 1;
+			return { rc.left >> k, rc.top >> k, (rc.right + m) >> k, (rc.bottom + m) >> k };
+		}
+		// the level whose scale is the nearest to, but not less than,
+		// the ratio of `num` / `den` (< 1). returns 0 if no reduction applies.
+		static constexpr int level_for(int num, int den) {
+			if (num <= 0 || den <= num) return 0;
+			int k = 0;
+			while (k < max_levels && (num << (k + 1)) <= den) k++;
+			return k;
+		}
+
+		// notifies that the `changed` area of the source has been modified,
+		// and that the source holds the valid pixels only within `available`.
+		void invalidate(const Rect& changed, const Rect& available)
+		{
+			dirty |= changed;
+			valid &= available;
+		}
+
+		// makes sure every level reflects the source within the `area`.
+		// the source must hold the valid pixels within the area aligned by aligned_area().
+		void prepare(const byte* src, int w, int h, Rect area)
+		{
+			if (levels[0].width != w || levels[0].height != h) {
+				reallocate(w, h);
+				valid = dirty = Rect::empty();
+			}
+			levels[0].bits = const_cast<byte*>(src);
+			for (int k = 1; k <= max_levels; k++) {
+				if (levels[k].bits == nullptr) { valid = dirty = Rect::empty(); return; }
+			}
+
+			area = aligned_area(area);
+			if (!valid.contains(area)) {
+				// rebuild the whole area.
+				build(area);
+				valid = area;
+			}
+			else if (!(dirty &= valid).is_empty()) build(dirty);
+			dirty = Rect::empty();
+		}
+
+		// extends the area so every pixel of every level in it is determined.
+		static constexpr Rect aligned_area(const Rect& area, int w, int h) {
+			auto const rc = reduce(area, max_levels);
+			return Rect{ rc.left << max_levels, rc.top << max_levels, rc.right << max_levels, rc.bottom << max_levels }
+				& Rect::of_size(w, h);
+		}
+		constexpr Rect aligned_area(const Rect& area) const {
+			return aligned_area(area, levels[0].width, levels[0].height);
+		}
+
+		// level `k` of the pyramid, 1 <= k <= max_levels.
+		constexpr const ImageView& level(int k) const { return levels[k]; }
+
+		void release()
+		{
+			for (auto& pool : pools) pool.release();
+			for (auto& level : levels) level = {};
+			valid = dirty = Rect::empty();
+		}
+	};
+}
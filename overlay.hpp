@@ -0,0 +1,145 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+
+#include "image_basics.hpp"
+#include "canvas.hpp"
+#include "text_format.hpp"
+
+////////////////////////////////
+// 色・座標表示と通知メッセージの配置．
+////////////////////////////////
+namespace sigma_lib::image::overlay
+{
+	// the spaces around the text of a tip or a toast.
+	struct Chrome {
+		int margin_h, margin_v;	// from the sides of the canvas to the frame.
+		int pad_h, pad_v;		// from the frame to the text.
+	};
+
+	// the area of the text, and that of the rounded rect around it excluding its frame.
+	struct Layout {
+		Rect text, frame;
+
+		// the area drawn including the frame of `thick`.
+		constexpr Rect bounds(int thick) const {
+			thick = std::max(thick, 0);
+			return frame.inflate(thick, thick);
+		}
+	};
+
+	// places the text of `w` x `h` centered above or below the `box`, `gap` apart from it,
+	// keeping it inside the canvas where possible.
+	// `prefer_above` tells the side to take if both fit, and is flipped if only the other fits.
+	constexpr Layout place_tip(const Rect& box, int w, int h, int canvas_w, int canvas_h,
+		int gap, const Chrome& chrome, bool& prefer_above)
+	{
+		int const x_min = chrome.margin_h + chrome.pad_h,
+			x_max = canvas_w - (w + chrome.pad_h + chrome.margin_h),
+			y_min = chrome.margin_v + chrome.pad_v,
+			y_max = canvas_h - (h + chrome.pad_v + chrome.margin_v);
+
+		int x = (box.left + box.right) / 2 - w / 2;
+
+		// choose whether the tip should be placed above or below the box.
+		int const yU = box.top - gap - chrome.pad_v - h,
+			yD = box.bottom + gap + chrome.pad_v;
+		if (bool const up = y_min <= yU, dn = yD <= y_max; up || dn)
+			prefer_above = prefer_above ? up : !dn;
+		int y = prefer_above ? yU : yD;
+
+		constexpr auto adjust = [](int v, int m, int M) { return m > M ? (m + M) / 2 : std::clamp(v, m, M); };
+		x = adjust(x, x_min, x_max);
+		y = adjust(y, y_min, y_max);
+
+		Rect const text{ x, y, x + w, y + h };
+		return { text, text.inflate(chrome.pad_h, chrome.pad_v) };
+	}
+
+	// places the text of `w` x `h` at a side or a corner of the canvas.
+	// `align_h` is -1 for the left, 0 for the center and +1 for the right, and `align_v` likewise from the top.
+	constexpr Layout place_toast(int w, int h, int canvas_w, int canvas_h,
+		int align_h, int align_v, const Chrome& chrome)
+	{
+		// the start of the frame on an axis, aligned to either end or centered.
+		constexpr auto start = [](int align, int len, int canvas, int margin, int pad) {
+			return align < 0 ? margin :
+				align > 0 ? canvas - margin - pad - len - pad :
+				canvas / 2 - len / 2 - pad;
+		};
+		int const x = start(align_h, w, canvas_w, chrome.margin_h, chrome.pad_h) + chrome.pad_h,
+			y = start(align_v, h, canvas_h, chrome.margin_v, chrome.pad_v) + chrome.pad_v;
+
+		Rect const text{ x, y, x + w, y + h };
+		return { text, text.inflate(chrome.pad_h, chrome.pad_v) };
+	}
+
+	// writes the position of the pixel of the tip as "X:%4d, Y:%4d",
+	// or, if `centered`, relative to the center of the `screen_w` x `screen_h` image. returns the length.
+	constexpr int put_coord(wchar_t* buf, int x, int y, int screen_w, int screen_h, bool centered)
+	{
+		using namespace sigma_lib::format;
+		int len = 0;
+		if (centered) {
+			// no half-integer when (scr & 1) == 0.
+			// at most 3 digits (plus sign) when scr < 2000. 4 digits is rarely necessary.
+			constexpr auto width = [](int scr) { return 1 + (scr < 2000 ? 3 : 4) + (2 * (scr & 1)); };
+			// "X:%*.*f, Y:%*.*f" of pix - screen / 2.0.
+			len += put(buf + len, L"X:");
+			len += put_half(buf + len, 2 * x - screen_w, width(screen_w));
+			len += put(buf + len, L", Y:");
+			len += put_half(buf + len, 2 * y - screen_h, width(screen_h));
+		}
+		else {
+			// "X:%4d, Y:%4d".
+			len += put(buf + len, L"X:");
+			len += put_int(buf + len, x, 4);
+			len += put(buf + len, L", Y:");
+			len += put_int(buf + len, y, 4);
+		}
+		return len;
+	}
+
+	// draws the box of the pixel the tip points to, filled with `color` and framed by `frame`.
+	inline void draw_pixel_box(Canvas& canvas, const Rect& box, uint32_t color, uint32_t frame)
+	{
+		if (box.is_empty()) return;
+		canvas.fill_rect(box, color);
+		canvas.fill_rect({ box.left, box.top, box.right, box.top + 1 }, frame);
+		canvas.fill_rect({ box.left, box.bottom - 1, box.right, box.bottom }, frame);
+		canvas.fill_rect({ box.left, box.top + 1, box.left + 1, box.bottom - 1 }, frame);
+		canvas.fill_rect({ box.right - 1, box.top + 1, box.right, box.bottom - 1 }, frame);
+	}
+
+	static_assert([] {
+		Chrome const chrome{ 4, 4, 10, 3 };
+		bool above = false;
+		auto const tip = place_tip({ 50, 50, 58, 58 }, 40, 16, 200, 100, 10, chrome, above);
+		auto const toast = place_toast(40, 16, 200, 100, +1, +1, chrome);
+		wchar_t buf[32]{};
+		auto const eq = [&](int n, const wchar_t* s) {
+			for (int i = 0; i < n; i++) if (buf[i] != s[i]) return false;
+			return s[n] == L'\0';
+		};
+		return !above && tip.text == Rect{ 34, 71, 74, 87 } &&
+			toast.frame == Rect{ 136, 74, 196, 96 } && toast.text == Rect{ 146, 77, 186, 93 } &&
+			eq(put_coord(buf, 3, 4, 100, 101, true), L"X: -47, Y: -46.5") &&
+			eq(put_coord(buf, 3, 4, 100, 101, false), L"X:   3, Y:   4");
+	}());
+}
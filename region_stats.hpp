@@ -0,0 +1,239 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+#pragma once
+
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+#include "image_basics.hpp"
+#include "frame_alloc.hpp"
+
+////////////////////////////////
+// 範囲内の色の統計．
+////////////////////////////////
+namespace sigma_lib::image
+{
+	// summed-area tables of the pixels and their squares,
+	// answering the average and the deviation of any rectangle inside in constant time.
+	// the tables are built lazily around the queried rectangle, and discarded when the image changes there.
+	class RegionStats {
+	public:
+		// the extra width around the queried rect the tables cover, so small moves won't rebuild.
+		constexpr static int margin = 64;
+
+		struct Stats {
+			int32_t count = 0;
+			// each in the order of B, G, R as in the image.
+			byte mean[3]{}, min[3]{}, max[3]{};
+			// the standard deviation in the unit of 1/10.
+			uint16_t deviation10[3]{};
+
+			constexpr bool operator==(const Stats&) const = default;
+
+			// the statistics of the single pixel.
+			constexpr static Stats of_pixel(byte b, byte g, byte r) {
+				return { 1, { b, g, r }, { b, g, r }, { b, g, r }, {} };
+			}
+		};
+
+	private:
+		FrameAllocator sum_pool{}, square_pool{};
+		// the entry at (x, y) is the sum over [left, left + x) x [top, top + y) of the `area`.
+		// the sums fit in 32 bits for areas up to 2^24 pixels.
+		uint32_t* sums = nullptr;
+		uint64_t* squares = nullptr;
+		size_t pitch = 0; // entries per row, 3 * (width + 1).
+
+		// the area the tables cover.
+		Rect area{};
+		// the widest row whose sums of the squares fit in 32 bits, 255^2 * w < 2^32.
+		constexpr static int max_simd_width = 66051;
+		bool valid = false;
+
+		// the vertical pass of the tables, `dst[i] += above[i]`.
+		template<class T>
+		static void accumulate(T* dst, const T* above, size_t len)
+		{
+			size_t i = 0;
+		#ifdef SIGMA_LIB_IMAGE_SSE2
+			constexpr size_t lanes = 16 / sizeof(T);
+			for (; i + lanes <= len; i += lanes) {
+				auto const a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i)),
+					b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(above + i));
+				if constexpr (sizeof(T) == 4)
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_add_epi32(a, b));
+				else _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_add_epi64(a, b));
+			}
+		#endif
+			for (; i < len; i++) dst[i] += above[i];
+		}
+
+	#ifdef SIGMA_LIB_IMAGE_SSE2
+		// the 32-bit entries of `x` shifted by `n` along the row, with `p` the 4 entries before.
+		template<int n>
+		static __m128i shift_entries(__m128i p, __m128i x)
+		{
+			return _mm_or_si128(_mm_slli_si128(x, 4 * n), _mm_srli_si128(p, 16 - 4 * n));
+		}
+		// the running sums along a row of 4 pixels of B, G, R, spread in 32-bit lanes over `v`,
+		// by the shift-and-add scan of the entries 3 and 6 before in the registers,
+		// plus `carry`, the last 4 sums of the previous pixels, which becomes the last 4 sums of these.
+		static void scan_row(__m128i(&v)[3], __m128i& carry)
+		{
+			auto const z = _mm_setzero_si128();
+			__m128i const a[3] = {
+				_mm_add_epi32(v[0], shift_entries<3>(z, v[0])),
+				_mm_add_epi32(v[1], shift_entries<3>(v[0], v[1])),
+				_mm_add_epi32(v[2], shift_entries<3>(v[1], v[2])),
+			};
+			// the lanes of 1, 2 and 3 of `carry` hold the last sums of B, G and R.
+			v[0] = _mm_add_epi32(a[0], _mm_shuffle_epi32(carry, _MM_SHUFFLE(1, 3, 2, 1)));
+			v[1] = _mm_add_epi32(_mm_add_epi32(a[1], shift_entries<2>(z, a[0])),
+				_mm_shuffle_epi32(carry, _MM_SHUFFLE(2, 1, 3, 2)));
+			v[2] = _mm_add_epi32(_mm_add_epi32(a[2], shift_entries<2>(a[0], a[1])),
+				_mm_shuffle_epi32(carry, _MM_SHUFFLE(3, 2, 1, 3)));
+			carry = v[2];
+		}
+	#endif
+
+		void build(const ImageView& src, const Rect& rc)
+		{
+			int const w = rc.width(), h = rc.height();
+			pitch = 3 * static_cast<size_t>(w + 1);
+			size_t const len = pitch * (h + 1);
+			sums = static_cast<uint32_t*>(sum_pool.allocate(sizeof(*sums) * len));
+			squares = static_cast<uint64_t*>(square_pool.allocate(sizeof(*squares) * len));
+			if (sums == nullptr || squares == nullptr) { valid = false; return; }
+
+			std::fill_n(sums, pitch, 0u);
+			std::fill_n(squares, pitch, 0ull);
+			for (int y = 0; y < h; y++) {
+				const byte* s = src.row(rc.top + y) + 3 * rc.left;
+				auto const d = sums + pitch * (y + 1);
+				auto const q = squares + pitch * (y + 1);
+
+				// the horizontal pass within the row.
+				d[0] = d[1] = d[2] = 0; q[0] = q[1] = q[2] = 0;
+				int x = 0;
+			#ifdef SIGMA_LIB_IMAGE_SSE2
+				// by 4 pixels, reading 16 bytes within the row, while the squares of a row fit in 32 bits.
+				if (w <= max_simd_width) {
+					__m128i sum_carry = _mm_setzero_si128(), square_carry = _mm_setzero_si128();
+					auto const z = _mm_setzero_si128();
+					for (; x + 6 <= w; x += 4, s += 12) {
+						auto const px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+						auto const lo = _mm_unpacklo_epi8(px, z), hi = _mm_unpackhi_epi8(px, z);
+						__m128i v[3] = { _mm_unpacklo_epi16(lo, z), _mm_unpackhi_epi16(lo, z), _mm_unpacklo_epi16(hi, z) };
+						__m128i sq[3] = { _mm_madd_epi16(v[0], v[0]), _mm_madd_epi16(v[1], v[1]), _mm_madd_epi16(v[2], v[2]) };
+						scan_row(v, sum_carry);
+						scan_row(sq, square_carry);
+
+						auto const i = 3 * (x + 1);
+						for (int k = 0; k < 3; k++) {
+							_mm_storeu_si128(reinterpret_cast<__m128i*>(d + i + 4 * k), v[k]);
+							_mm_storeu_si128(reinterpret_cast<__m128i*>(q + i + 4 * k), _mm_unpacklo_epi32(sq[k], z));
+							_mm_storeu_si128(reinterpret_cast<__m128i*>(q + i + 4 * k + 2), _mm_unpackhi_epi32(sq[k], z));
+						}
+					}
+				}
+			#endif
+				// the rest, continuing from the sums so far.
+				uint32_t a0 = d[3 * x], a1 = d[3 * x + 1], a2 = d[3 * x + 2];
+				uint64_t b0 = q[3 * x], b1 = q[3 * x + 1], b2 = q[3 * x + 2];
+				for (; x < w; x++, s += 3) {
+					a0 += s[0]; a1 += s[1]; a2 += s[2];
+					b0 += s[0] * s[0]; b1 += s[1] * s[1]; b2 += s[2] * s[2];
+					auto const i = 3 * (x + 1);
+					d[i] = a0; d[i + 1] = a1; d[i + 2] = a2;
+					q[i] = b0; q[i + 1] = b1; q[i + 2] = b2;
+				}
+
+				// then add the row above.
+				accumulate(d, d - pitch, pitch);
+				accumulate(q, q - pitch, pitch);
+			}
+			area = rc;
+			valid = true;
+		}
+
+		// the sum over `rc` relative to `area`, from the four corners of the table.
+		template<class T>
+		T corner_sum(const T* table, const Rect& rc, int c) const
+		{
+			auto const at = [&](int x, int y) { return table[pitch * y + 3 * x + c]; };
+			return at(rc.right, rc.bottom) - at(rc.left, rc.bottom) - at(rc.right, rc.top) + at(rc.left, rc.top);
+		}
+
+	public:
+		// the `size` x `size` square around the pixel at (`x`, `y`).
+		static constexpr Rect neighborhood(int x, int y, int size) {
+			x -= (size - 1) >> 1; y -= (size - 1) >> 1;
+			return { x, y, x + size, y + size };
+		}
+
+		// notifies that the `changed` area of the source has been modified,
+		// and that the source holds the valid pixels only within `available`.
+		void invalidate(const Rect& changed, const Rect& available)
+		{
+			if (changed.intersects(area) || !available.contains(area)) valid = false;
+		}
+
+		// the statistics of the pixels of `src` within `rc`, clipped to the image.
+		// the source must hold the valid pixels within `rc` inflated by `margin`.
+		Stats query(const ImageView& src, Rect rc)
+		{
+			auto const whole = Rect::of_size(src.width, src.height);
+			rc &= whole;
+			if (rc.is_empty()) return {};
+			if (!valid || !area.contains(rc)) {
+				build(src, rc.inflate(margin, margin) & whole);
+				if (!valid) return {};
+			}
+
+			Stats ret{ .count = rc.width() * rc.height() };
+			auto const rel = rc.offset(-area.left, -area.top);
+			double const n = ret.count;
+			for (int c = 0; c < 3; c++) {
+				double const sum = corner_sum(sums, rel, c), sq = static_cast<double>(corner_sum(squares, rel, c));
+				ret.mean[c] = static_cast<byte>(std::lround(sum / n));
+				ret.deviation10[c] = static_cast<uint16_t>(std::lround(10 * std::sqrt(std::max(sq / n - (sum / n) * (sum / n), 0.0))));
+			}
+
+			// the extremes aren't additive, so scan the pixels.
+			byte lo[3]{ 255, 255, 255 }, hi[3]{ 0, 0, 0 };
+			for (int y = rc.top; y < rc.bottom; y++) {
+				const byte* s = src.row(y) + 3 * rc.left;
+				for (int x = rc.left; x < rc.right; x++, s += 3) {
+					for (int c = 0; c < 3; c++) {
+						lo[c] = std::min(lo[c], s[c]);
+						hi[c] = std::max(hi[c], s[c]);
+					}
+				}
+			}
+			std::copy_n(lo, 3, ret.min); std::copy_n(hi, 3, ret.max);
+			return ret;
+		}
+
+		void release()
+		{
+			sum_pool.release(); square_pool.release();
+			sums = nullptr; squares = nullptr;
+			area = Rect::empty();
+			valid = false;
+		}
+	};
+}
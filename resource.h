@@ -93,6 +93,29 @@
 #define IDS_DLG_TOAST_SAMPLE            189
 #define IDS_COLOR_THEME_LIGHT           190
 #define IDS_COLOR_THEME_DARK            191
+#define IDS_TIP_COLOR_FMT_MEAN          192
+#define IDS_TIP_COLOR_FMT_STATS         193
+#define IDS_CXT_COLOR_FMT_MEAN          194
+#define IDS_CXT_COLOR_FMT_STATS         195
+#define IDS_CMD_TOGGLE_HISTOGRAM        196
+#define IDS_DESC_CMD_HISTOGRAM          197
+#define IDS_CMD_TOGGLE_DIFFERENCE       198
+#define IDS_DESC_CMD_DIFFERENCE         199
+#define IDS_CMD_TOGGLE_LUT              200
+#define IDS_DESC_CMD_LUT                201
+#define IDS_TOAST_LUT_FAILED            202
+#define IDS_TIP_COLOR_FMT_HSV           203
+#define IDS_TIP_COLOR_FMT_HLS           204
+#define IDS_TIP_COLOR_FMT_Y601          205
+#define IDS_TIP_COLOR_FMT_Y709          206
+#define IDS_TIP_COLOR_FMT_LAB           207
+#define IDS_TIP_COLOR_FMT_LCH           208
+#define IDS_CXT_COLOR_FMT_HSV           209
+#define IDS_CXT_COLOR_FMT_HLS           210
+#define IDS_CXT_COLOR_FMT_Y601          211
+#define IDS_CXT_COLOR_FMT_Y709          212
+#define IDS_CXT_COLOR_FMT_LAB           213
+#define IDS_CXT_COLOR_FMT_LCH           214
 #define IDD_VSCROLLFORM                 800
 #define IDD_SETTINGS                    801
 #define IDD_SETTINGS_FORM_CLICK_ACTION  802
@@ -170,13 +193,16 @@
 #define IDM_CXT_TIP_MODE_STICKY         40010
 #define IDM_CXT_REVERSE_WHEEL           40011
 #define IDM_CXT_SETTINGS                40012
+#define IDM_CXT_SHOW_HISTOGRAM          40013
+#define IDM_CXT_SHOW_DIFFERENCE         40014
+#define IDM_CXT_SHOW_LUT                40015
 
 // Next default values for new objects
 // 
 #ifdef APSTUDIO_INVOKED
 #ifndef APSTUDIO_READONLY_SYMBOLS
 #define _APS_NEXT_RESOURCE_VALUE        822
-#define _APS_NEXT_COMMAND_VALUE         40013
+#define _APS_NEXT_COMMAND_VALUE         40016
 #define _APS_NEXT_CONTROL_VALUE         1044
 #define _APS_NEXT_SYMED_VALUE           101
 #endif
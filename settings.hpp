@@ -35,6 +35,10 @@ inline constinit struct Settings {
 
 	enum class ColorFormat : uint8_t {
 		hexdec6 = 0, dec3x3 = 1,
+		// the statistics of the square around the pixel.
+		mean_hexdec6 = 2, stats_dec3x3 = 3,
+		// the pixel in other color spaces.
+		hsv = 4, hls = 5, ycbcr601 = 6, ycbcr709 = 7, lab = 8, lch = 9,
 	};
 	enum class CoordFormat : uint8_t {
 		origin_top_left = 0, origin_center = 1,
@@ -98,6 +102,7 @@ inline constinit struct Settings {
 
 		ColorFormat color_fmt = ColorFormat::hexdec6;
 		CoordFormat coord_fmt = CoordFormat::origin_top_left;
+		int8_t stats_size		= 5; // the side length of the square for the statistics.
 
 		wchar_t font_name[LF_FACESIZE]{ L"Consolas" };
 		int8_t font_size		= 16;
@@ -111,6 +116,7 @@ inline constinit struct Settings {
 		int8_t chrome_pad_h		= 10;
 		int8_t chrome_pad_v		= 3;
 
+		constexpr static int8_t stats_size_min		= 1,	stats_size_max		= 64;
 		constexpr static int8_t font_size_min		= 4,	font_size_max		= 72;
 		constexpr static int8_t box_inflate_min		= 0,	box_inflate_max		= 16;
 		constexpr static int8_t box_tip_gap_min		= -64,	box_tip_gap_max		= 64;
@@ -228,6 +234,8 @@ inline constinit struct Settings {
 	struct Grid {
 		int8_t least_zoom_thin = 8;
 		int8_t least_zoom_thick = 12;
+		// choose the colors of the lines by the brightness of the pixels under them.
+		bool adaptive = false;
 		constexpr static int8_t
 			least_zoom_thin_min	= 6, // x 3.00
 			least_zoom_thin_max	= Zoom::level_max_max + 1,
@@ -254,6 +262,9 @@ inline constinit struct Settings {
 			zoom_step_down			= 7,
 			zoom_step_up			= 8,
 			bring_center			= 9,
+			toggle_histogram		= 10,
+			toggle_difference		= 11,
+			toggle_lut				= 12,
 			settings				= 201,
 			context_menu			= 202,
 		};
@@ -276,8 +287,67 @@ inline constinit struct Settings {
 
 		ColorFormat copy_color_fmt = ColorFormat::hexdec6;
 		CoordFormat copy_coord_fmt = CoordFormat::origin_top_left;
+		int8_t copy_stats_size = 5;
+		constexpr static int8_t
+			copy_stats_size_min = TipDrag::stats_size_min,
+			copy_stats_size_max = TipDrag::stats_size_max;
 	} commands;
 
+	struct Lut {
+		// the .cube file to preview the picture through.
+		// relative paths are from the directory of this plugin.
+		wchar_t file[MAX_PATH]{};
+
+		// whether the tip and the copied color codes show the colors through the LUT while it's applied.
+		bool tip_transformed = false, copy_transformed = false;
+	} lut;
+
+	struct Performance {
+		// how to take in the image from AviUtl on each frame.
+		enum class Ingest : uint8_t {
+			full = 0,		// copy the entire frame.
+			viewbox = 1,	// copy the area around the view box only, and the rest on demand.
+			borrow = 2,		// use the frame of AviUtl directly while drawing, and copy on demand afterwards.
+		};
+		Ingest ingest = Ingest::full;
+		// extra pixels to copy around the view box for the `viewbox` mode.
+		int16_t ingest_margin = 64;
+		constexpr static int16_t ingest_margin_min = 0, ingest_margin_max = 4096;
+
+		// use large pages for the image if available.
+		bool large_pages = false;
+
+		// draw zoomed-out images from the box-filtered reductions.
+		bool mipmap = false;
+
+		// magnify images by the software renderer instead of GDI.
+		bool upscaler = false;
+
+		// reuse the previous drawing when the view is scrolled.
+		bool scroll_reuse = false;
+
+		// keep the picture, the grid and the overlays in separate layers,
+		// and redraw only the layers that have changed.
+		bool layer_cache = false;
+
+		// draw the grid directly onto the pixels instead of by GDI.
+		bool grid_raster = false;
+
+		// keep the backgrounds of the tips and toasts drawn, and copy them onto the pixels.
+		bool chrome_cache = false;
+
+		// draw the texts of the tips and toasts from the glyphs rasterized beforehand.
+		bool glyph_atlas = false;
+
+		// draw the backplane, the picture, the grid and the pixel box of the tip
+		// directly onto the pixels of the buffers instead of by GDI.
+		bool raster_canvas = false;
+
+		// the number of threads for the software upscaling and grid drawing.
+		int8_t render_threads = 1;
+		constexpr static int8_t render_threads_min = 1, render_threads_max = 16;
+	} performance;
+
 	// loading from .ini file.
 	void load(const char* ini_file)
 	{
@@ -318,6 +388,7 @@ inline constinit struct Settings {
 		load_enum(tip_drag, rail_mode);
 		load_enum(tip_drag, color_fmt);
 		load_enum(tip_drag, coord_fmt);
+		load_int(tip_drag, stats_size);
 		load_int(tip_drag, font_size);
 		load_int(tip_drag, box_inflate);
 		load_int(tip_drag, box_tip_gap);
@@ -377,6 +448,7 @@ inline constinit struct Settings {
 
 		load_int(grid, least_zoom_thin);
 		load_int(grid, least_zoom_thick);
+		load_bool(grid, adaptive);
 
 		load_enum(commands, left.click);
 		load_enum(commands, left.dblclk);
@@ -399,6 +471,28 @@ inline constinit struct Settings {
 		load_int(commands, step_zoom_num_steps);
 		load_enum(commands, copy_color_fmt);
 		load_enum(commands, copy_coord_fmt);
+		load_int(commands, copy_stats_size);
+
+		{
+			char buf_ansi[3 * std::extent_v<decltype(lut.file)>];
+			if (::GetPrivateProfileStringA("lut", "file", "", buf_ansi, std::size(buf_ansi), ini_file) > 0)
+				::MultiByteToWideChar(CP_UTF8, 0, buf_ansi, -1, lut.file, std::size(lut.file));
+		}
+		load_bool(lut, tip_transformed);
+		load_bool(lut, copy_transformed);
+
+		load_enum(performance, ingest);
+		load_int(performance, ingest_margin);
+		load_bool(performance, large_pages);
+		load_bool(performance, mipmap);
+		load_bool(performance, upscaler);
+		load_bool(performance, scroll_reuse);
+		load_bool(performance, layer_cache);
+		load_bool(performance, grid_raster);
+		load_bool(performance, chrome_cache);
+		load_bool(performance, glyph_atlas);
+		load_bool(performance, raster_canvas);
+		load_int(performance, render_threads);
 
 	#undef load_drag
 	#undef load_zoom
@@ -446,6 +540,7 @@ inline constinit struct Settings {
 		save_dec(tip_drag, rail_mode);
 		save_dec(tip_drag, color_fmt);
 		save_dec(tip_drag, coord_fmt);
+		save_dec(tip_drag, stats_size);
 		save_dec(tip_drag, font_size);
 		save_dec(tip_drag, box_inflate);
 		save_dec(tip_drag, box_tip_gap);
@@ -504,6 +599,7 @@ inline constinit struct Settings {
 
 		save_dec(grid, least_zoom_thin);
 		save_dec(grid, least_zoom_thick);
+		save_bool(grid, adaptive);
 
 		save_dec(commands, left.click);
 		save_dec(commands, left.dblclk);
@@ -526,8 +622,24 @@ inline constinit struct Settings {
 		save_dec(commands, step_zoom_num_steps);
 		save_dec(commands, copy_color_fmt);
 		save_dec(commands, copy_coord_fmt);
-
-		// lines commented out are setting items that threre're no means to change at runtime. (all cleared now.)
+		save_dec(commands, copy_stats_size);
+
+		// lines commented out are setting items that threre're no means to change at runtime.
+		//save_bool(lut, tip_transformed);
+		//save_bool(lut, copy_transformed);
+
+		//save_dec(performance, ingest);
+		//save_dec(performance, ingest_margin);
+		//save_bool(performance, large_pages);
+		//save_bool(performance, mipmap);
+		//save_bool(performance, upscaler);
+		//save_bool(performance, scroll_reuse);
+		//save_bool(performance, layer_cache);
+		//save_bool(performance, grid_raster);
+		//save_bool(performance, chrome_cache);
+		//save_bool(performance, glyph_atlas);
+		//save_bool(performance, raster_canvas);
+		//save_dec(performance, render_threads);
 
 	#undef save_drag
 	#undef save_zoom
@@ -0,0 +1,158 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+#pragma once
+
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+
+////////////////////////////////
+// 帯状分割の並列処理．
+////////////////////////////////
+namespace sigma_lib::image
+{
+	// a small pool of persistent threads that processes the strips of an image.
+	// the tasks are taken in order by whichever thread is free, the caller included,
+	// so the result doesn't depend on the number of threads as long as the tasks don't overlap.
+	class StripPool {
+		struct State {
+			std::mutex mtx{};
+			std::condition_variable wake{}, done{};
+			std::vector<std::thread> threads{};
+			uint32_t generation = 0;
+			int active = 0;
+			bool quit = false;
+
+			// the current job.
+			void (*func)(void*, int) = nullptr;
+			void* cxt = nullptr;
+			int num_tasks = 0;
+			std::atomic_int next{ 0 }, finished{ 0 };
+
+			// runs the tasks until none is left.
+			// the job is passed as taken under the lock, not read from the members.
+			void work(void (*f)(void*, int), void* c, int n)
+			{
+				for (int i; (i = next.fetch_add(1)) < n;) {
+					f(c, i);
+					finished.fetch_add(1);
+				}
+			}
+			void worker()
+			{
+				uint32_t seen = 0;
+				while (true) {
+					decltype(func) f; void* c; int n;
+					{
+						std::unique_lock lock{ mtx };
+						wake.wait(lock, [&] { return quit || generation != seen; });
+						if (quit) return;
+						seen = generation;
+						f = func; c = cxt; n = num_tasks;
+						active++;
+					}
+					work(f, c, n);
+					{
+						std::lock_guard lock{ mtx };
+						active--;
+					}
+					done.notify_all();
+				}
+			}
+		};
+		std::unique_ptr<State> state{};
+		int num_threads = 1;
+
+		// starts the threads unless running.
+		State* start()
+		{
+			if (num_threads <= 1) return nullptr;
+			if (state) return state.get();
+
+			state = std::make_unique<State>();
+			for (int i = 1; i < num_threads; i++)
+				state->threads.emplace_back([s = state.get()] { s->worker(); });
+			return state.get();
+		}
+
+	public:
+		constexpr StripPool() = default;
+		StripPool(const StripPool&) = delete;
+		~StripPool() { release(); }
+
+		// sets the number of threads to run the tasks, including the calling thread.
+		void set_threads(int threads)
+		{
+			threads = std::max(threads, 1);
+			if (threads == num_threads) return;
+			release();
+			num_threads = threads;
+		}
+		constexpr int threads() const { return num_threads; }
+
+		// calls `task(i)` for each `i` in [0, `num_tasks`), possibly in parallel, and waits for all of them.
+		void run(int num_tasks, auto&& task)
+		{
+			if (num_tasks <= 0) return;
+			auto* const s = num_tasks > 1 ? start() : nullptr;
+			if (s == nullptr) {
+				for (int i = 0; i < num_tasks; i++) task(i);
+				return;
+			}
+
+			using task_t = std::remove_reference_t<decltype(task)>;
+			auto const f = +[](void* cxt, int i) { (*static_cast<task_t*>(cxt))(i); };
+			auto const c = const_cast<void*>(static_cast<const void*>(std::addressof(task)));
+			{
+				// a worker that woke up late for the previous job may still be
+				// in the loop of `work()`; let it leave before resetting the counters.
+				std::unique_lock lock{ s->mtx };
+				s->done.wait(lock, [&] { return s->active == 0; });
+				s->func = f;
+				s->cxt = c;
+				s->num_tasks = num_tasks;
+				s->finished = 0;
+				s->next = 0;
+				s->generation++;
+			}
+			s->wake.notify_all();
+			s->work(f, c, num_tasks);
+
+			// wait also for the workers to leave, so none of them takes the tasks of the next job.
+			std::unique_lock lock{ s->mtx };
+			s->done.wait(lock, [&] { return s->finished == num_tasks && s->active == 0; });
+		}
+
+		// stops the threads. they start again when needed.
+		void release()
+		{
+			if (!state) return;
+			{
+				std::lock_guard lock{ state->mtx };
+				state->quit = true;
+			}
+			state->wake.notify_all();
+			for (auto& t : state->threads) t.join();
+			state.reset();
+		}
+	};
+}
@@ -0,0 +1,100 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include <cstdint>
+
+#include "image_basics.hpp"
+#include "frame_alloc.hpp"
+
+////////////////////////////////
+// 描画先の抽象化．
+////////////////////////////////
+namespace sigma_lib::image
+{
+	// a drawing target that persists across frames, and is reallocated only when resized.
+	// the pixels are 24bpp or 32bpp as the implementation chooses, told by `depth` of the view;
+	// DIBSurface of the back buffer is 32bpp.
+	class Surface {
+	public:
+		struct Stats {
+			uint32_t num_allocs;	// the number of allocations so far.
+			uint32_t frame_allocs;	// the number of allocations since the last begin_frame().
+			uint32_t frames;		// the number of times begin_frame() was called.
+		};
+
+	protected:
+		ImageView pixels{};
+		Stats counts{};
+
+		// allocates the pixels of the size, replacing the previous ones.
+		// should set `pixels` and return true on success.
+		virtual bool allocate(int width, int height) = 0;
+		// frees the pixels. `pixels` is reset by the caller.
+		virtual void deallocate() = 0;
+
+	public:
+		constexpr Surface() = default;
+		constexpr virtual ~Surface() = default;
+		Surface(const Surface&) = delete;
+		Surface(Surface&&) = delete;
+
+		// makes sure the surface has the specified size.
+		// returns true if reallocated, whose content is undefined then.
+		bool resize(int width, int height)
+		{
+			if (is_valid() && pixels.width == width && pixels.height == height) return false;
+			if (width <= 0 || height <= 0 || !allocate(width, height)) {
+				release();
+				return true;
+			}
+			counts.num_allocs++; counts.frame_allocs++;
+			return true;
+		}
+		void release()
+		{
+			if (is_valid()) deallocate();
+			pixels = {};
+		}
+
+		// marks the beginning of a frame, to count allocations per frame.
+		void begin_frame() { counts.frames++; counts.frame_allocs = 0; }
+
+		constexpr const ImageView& view() const { return pixels; }
+		constexpr int width() const { return pixels.width; }
+		constexpr int height() const { return pixels.height; }
+		constexpr bool is_valid() const { return pixels.bits != nullptr; }
+		constexpr const Stats& stats() const { return counts; }
+	};
+
+	// a surface on the plain memory.
+	class MemorySurface final : public Surface {
+		FrameAllocator pool{};
+
+		bool allocate(int width, int height) override
+		{
+			auto const stride = ImageView::stride_of(width);
+			auto bits = static_cast<byte*>(pool.allocate(stride * height));
+			if (bits == nullptr) return false;
+			pixels = { bits, width, height, stride };
+			return true;
+		}
+		void deallocate() override { pool.release(); }
+
+	public:
+		constexpr MemorySurface() = default;
+		~MemorySurface() override { release(); }
+	};
+}
@@ -0,0 +1,92 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "test_util.hpp"
+#include "color_space.hpp"
+#include "histogram.hpp"
+
+using namespace sigma_lib;
+using color_space::byte;
+
+// `n` random pixels of B, G, R, with the extremes mixed in.
+static std::vector<byte> random_pixels(int n, uint32_t seed)
+{
+	std::vector<byte> ret(3 * n);
+	test_util::Rng rng{ seed };
+	for (auto& v : ret) {
+		auto const r = rng();
+		v = r % 8 == 0 ? 0 : r % 8 == 1 ? 255 : static_cast<byte>(r >> 8);
+	}
+	return ret;
+}
+
+// the spans of the lumas agree with the scalar ones, at every length for the remainders.
+static void test_luma_spans()
+{
+	auto const px = random_pixels(4099, 1);
+	std::vector<byte> out(4099);
+	for (int n : { 0, 1, 5, 6, 7, 64, 4099 }) {
+		color_space::color_luma_span(px.data(), out.data(), n);
+		bool ok = true;
+		for (int i = 0; i < n; i++) {
+			const byte* p = &px[3 * i];
+			ok &= out[i] == color_space::color_luma(p[2], p[1], p[0]) >> 8;
+		}
+		CHECK(ok);
+	}
+	// the half of the maximum is where the adaptive grid switches.
+	byte const grays[] = { 127, 127, 127, 128, 128, 128 };
+	byte y[2];
+	color_space::color_luma_span(grays, y, 2);
+	CHECK(y[0] == 127 && y[1] == 128);
+	CHECK(color_space::color_luma(127, 127, 127) <= 65535 / 2 && color_space::color_luma(128, 128, 128) > 65535 / 2);
+}
+
+// the histogram counts the luma of Color::luma(), and moving it gives the same counts as counting anew.
+static void test_histogram()
+{
+	test_util::Image img{ 97, 61 };
+	test_util::fill_noise(img, 9);
+	image::Rect const rc{ 5, 3, 80, 50 };
+
+	image::Histogram a{}, b{};
+	a.update(img.view, rc);
+	uint32_t lumas[256]{};
+	for (int y = rc.top; y < rc.bottom; y++)
+		for (int x = rc.left; x < rc.right; x++) {
+			auto const p = img.at(x, y);
+			lumas[color_space::color_luma(p[2], p[1], p[0]) >> 8]++;
+		}
+	CHECK(std::memcmp(a.counts()[image::Histogram::luma], lumas, sizeof(lumas)) == 0);
+
+	for (auto [dx, dy] : { std::pair{ 3, 0 }, { 0, -2 }, { -7, 5 }, { 1, 1 } }) {
+		auto const moved = a.rect().offset(dx, dy);
+		a.update(img.view, moved);
+		b.invalidate(image::Rect::of_size(97, 61), image::Rect::of_size(97, 61));
+		b.update(img.view, moved);
+		CHECK(std::memcmp(a.counts(), b.counts(), sizeof(image::Histogram::Bins)) == 0);
+	}
+}
+
+int main()
+{
+	test_luma_spans();
+	test_histogram();
+	return test_util::result("color_space");
+}
@@ -0,0 +1,140 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+#include <cstdint>
+#include <cstring>
+
+#include "test_util.hpp"
+#include "frame_borrow.hpp"
+#include "image_buffer.hpp"
+
+using namespace sigma_lib::image;
+using test_util::Image;
+
+// stands for the functions of AviUtl that lend the frame, as frame_source in color_loupe.cpp uses them.
+struct MockExfunc {
+	bool editing = true, saving = false;
+	int w = 0, h = 0;
+	const void* pixels = nullptr;
+	int calls = 0;
+
+	// same as frame_source: the frame displayed if its size matches, or nullptr.
+	const void* operator()(int width, int height)
+	{
+		calls++;
+		if (!editing || saving || width != w || height != h) return nullptr;
+		return pixels;
+	}
+};
+
+static void test_tickets()
+{
+	int a = 0, b = 0;
+	FrameBorrow borrow{};
+	CHECK(borrow.get({}) == nullptr);
+
+	auto const t1 = borrow.lend(&a);
+	CHECK(borrow.get(t1) == &a);
+	CHECK(borrow.get({}) == nullptr);
+
+	// lending another frame closes the previous window.
+	auto const t2 = borrow.lend(&b);
+	CHECK(!(t1 == t2));
+	CHECK(borrow.get(t1) == nullptr);
+	CHECK(borrow.get(t2) == &b);
+
+	// closing invalidates the ticket, and closing again changes nothing.
+	borrow.close();
+	CHECK(borrow.get(t2) == nullptr);
+	borrow.close();
+	auto const t3 = borrow.lend(&a);
+	CHECK(borrow.get(t3) == &a);
+	CHECK(borrow.get(t1) == nullptr && borrow.get(t2) == nullptr);
+
+	// the same frame lent again is of a new window.
+	auto const t4 = borrow.lend(&a);
+	CHECK(borrow.get(t3) == nullptr && borrow.get(t4) == &a);
+}
+
+static void test_image_buffer()
+{
+	constexpr int w = 40, h = 30;
+	Image frame{ w, h };
+	test_util::fill_noise(frame, 3);
+	MockExfunc host{ .w = w, .h = h, .pixels = frame.view.bits };
+	auto const pixel = [&](const Image& img, int x, int y) { return img.colorref(x, y); };
+
+	ImageBuffer image{};
+	CHECK(image.update_borrowed(w, h, host.pixels));
+	CHECK(image.buffer() == frame.view.bits);
+	CHECK(image.current_rect() == Rect::of_size(w, h));
+	CHECK(image.color_at(5, 7) == pixel(frame, 5, 7));
+
+	// nothing is fetched while borrowing.
+	CHECK(image.ensure(Rect::of_size(w, h), 0, host));
+	CHECK(host.calls == 0);
+
+	// the host moves on; the borrowed pointer must not be used any longer.
+	image.close_borrow();
+	CHECK(image.buffer() != frame.view.bits);
+	CHECK(image.current_rect().is_empty());
+
+	// the pixels are fetched on demand, only the area with the margin.
+	CHECK(image.ensure({ 10, 10, 12, 12 }, 2, host));
+	CHECK(host.calls == 1);
+	CHECK(image.cached_rect() == Rect{ 8, 8, 14, 14 });
+	CHECK(image.color_at(13, 8) == pixel(frame, 13, 8));
+	CHECK(image.ensure({ 9, 9, 13, 13 }, 2, host));
+	CHECK(host.calls == 1);
+
+	// an overlapping area joins the cached one.
+	CHECK(image.ensure({ 13, 8, 16, 10 }, 0, host));
+	CHECK(host.calls == 2);
+	CHECK(image.cached_rect() == Rect{ 8, 8, 16, 14 });
+	CHECK(image.color_at(15, 13) == pixel(frame, 15, 13));
+
+	// the frame unavailable while saving or after editing.
+	host.saving = true;
+	CHECK(!image.ensure({ 0, 0, 2, 2 }, 0, host));
+	host.saving = false; host.editing = false;
+	CHECK(!image.ensure({ 0, 0, 2, 2 }, 0, host));
+	host.editing = true;
+
+	// a frame of another size is refused.
+	host.w = w + 1;
+	CHECK(!image.ensure({ 0, 0, 2, 2 }, 0, host));
+	host.w = w;
+
+	// a new borrow window shows the new frame, and copying closes it.
+	Image next{ w, h };
+	test_util::fill_noise(next, 9);
+	CHECK(!image.update_borrowed(w, h, next.view.bits));
+	CHECK(image.color_at(3, 3) == pixel(next, 3, 3));
+	CHECK(!image.update(w, h, frame.view.bits));
+	CHECK(image.buffer() != next.view.bits && image.buffer() != frame.view.bits);
+	CHECK(image.color_at(3, 3) == pixel(frame, 3, 3));
+	CHECK(image.color_at(-1, 3) == ImageBuffer::invalid_color);
+
+	image.free();
+	CHECK(!image.is_valid());
+	CHECK(image.buffer() == nullptr);
+}
+
+int main()
+{
+	test_tickets();
+	test_image_buffer();
+	return test_util::result("frame_borrow");
+}
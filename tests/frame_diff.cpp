@@ -0,0 +1,130 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+
+
+
+
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+
+#include "test_util.hpp"
+#include "frame_diff.hpp"
+
+using namespace sigma_lib::image;
+using test_util::Image;
+
+// the false color expected at (`x`, `y`) between the two frames.
+static const byte* expected(const Image& now, const Image& last, int x, int y)
+{
+	const byte* p = now.at(x, y), * q = last.at(x, y);
+	int d = 0;
+	for (int c = 0; c < 3; c++) d = std::max(d, std::abs(p[c] - q[c]));
+	return FrameDiff::palette[d].data();
+}
+
+// whether heatmap() within `rc` holds the differences between the frames, and `unknown` outside `known`.
+static bool heat_matches(const FrameDiff& diff, const Rect& rc, const Image& now, const Image& last, const Rect& known)
+{
+	auto const& heat = diff.heatmap();
+	auto const& area = diff.heatmap_area();
+	if (area != rc || heat.width != rc.width() || heat.height != rc.height()) return false;
+	for (int y = rc.top; y < rc.bottom; y++) for (int x = rc.left; x < rc.right; x++) {
+		const byte* h = heat.row(y - area.top) + 3 * (x - area.left);
+		if (known.contains(x, y)) {
+			if (!std::equal(h, h + 3, expected(now, last, x, y))) return false;
+		}
+		else if (h[0] != FrameDiff::unknown || h[1] != FrameDiff::unknown || h[2] != FrameDiff::unknown) return false;
+	}
+	return true;
+}
+
+// the buffers cover the viewed area with the margin, and the heatmap just the rendered rect.
+static void test_areas()
+{
+	Image a{ 640, 360 }, b{ 640, 360 };
+	test_util::fill_noise(a, 3);
+	test_util::fill_noise(b, 5);
+	auto const whole = Rect::of_size(640, 360);
+	FrameDiff diff{};
+
+	Rect const view{ 200, 100, 300, 180 };
+	diff.next_frame(1);
+	diff.capture(a.view, view, whole);
+	diff.render(view);
+	CHECK(heat_matches(diff, view, a, a, Rect::empty()));
+
+	// panning within the margin still knows the previous frame.
+	auto const moved = view.offset(40, -30);
+	diff.next_frame(2);
+	diff.capture(b.view, moved, whole);
+	diff.render(moved);
+	CHECK(heat_matches(diff, moved, b, a, moved));
+
+	// beyond the margin, the new part is unknown.
+	auto const far = view.offset(view.width() + 2 * FrameDiff::margin, 0);
+	diff.next_frame(3);
+	diff.capture(a.view, far, whole);
+	diff.render(far);
+	CHECK(heat_matches(diff, far, a, b, far & moved.inflate(FrameDiff::margin, FrameDiff::margin)));
+
+	// the margin is limited to the area holding the frame.
+	Rect const available{ 180, 90, 320, 200 };
+	diff.next_frame(4);
+	diff.capture(b.view, view, available);
+	diff.next_frame(5);
+	diff.capture(a.view, view.offset(-30, 0), whole);
+	diff.render(view.offset(-30, 0));
+	CHECK(heat_matches(diff, view.offset(-30, 0), a, b, view.offset(-30, 0) & available));
+}
+
+// a re-render of the same frame replaces its pixels, and is still compared with the frame before.
+static void test_rerender()
+{
+	Image a{ 160, 90 }, b{ 160, 90 }, c{ 160, 90 };
+	test_util::fill_noise(a, 7);
+	test_util::fill_noise(b, 9);
+	test_util::fill_noise(c, 11);
+	auto const whole = Rect::of_size(160, 90);
+	FrameDiff diff{};
+
+	diff.next_frame(10);
+	diff.capture(a.view, whole, whole);
+	diff.next_frame(11);
+	diff.capture(b.view, whole, whole);
+	diff.render(whole);
+	CHECK(heat_matches(diff, whole, b, a, whole));
+
+	diff.next_frame(11);
+	diff.capture(c.view, whole, whole);
+	diff.render(whole);
+	CHECK(heat_matches(diff, whole, c, a, whole));
+
+	// frames of another size aren't compared.
+	Image d{ 100, 50 };
+	test_util::fill_noise(d, 13);
+	diff.next_frame(12);
+	diff.capture(d.view, Rect::of_size(100, 50), Rect::of_size(100, 50));
+	diff.render(Rect::of_size(100, 50));
+	CHECK(heat_matches(diff, Rect::of_size(100, 50), d, d, Rect::empty()));
+}
+
+int main()
+{
+	test_areas();
+	test_rerender();
+	return test_util::result("frame_diff");
+}
@@ -0,0 +1,151 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+#include <iterator>
+
+#include "test_util.hpp"
+
+////////////////////////////////
+// 合成フレームの生成．
+////////////////////////////////
+namespace test_frames
+{
+	using namespace sigma_lib::image;
+	using test_util::Image;
+
+	// the 5x7 dots of the characters used in the tests, from the top row; bit 4 is the leftmost.
+	// other characters get dots made up from their codes.
+	inline void dots_of(wchar_t c, uint8_t(&rows)[7])
+	{
+		struct Entry { wchar_t c; uint8_t rows[7]; };
+		constexpr Entry table[] = {
+			{ L'0', { 0x0e, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0e } },
+			{ L'1', { 0x04, 0x0c, 0x04, 0x04, 0x04, 0x04, 0x0e } },
+			{ L'2', { 0x0e, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1f } },
+			{ L'3', { 0x1f, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0e } },
+			{ L'4', { 0x02, 0x06, 0x0a, 0x12, 0x1f, 0x02, 0x02 } },
+			{ L'5', { 0x1f, 0x10, 0x1e, 0x01, 0x01, 0x11, 0x0e } },
+			{ L'6', { 0x06, 0x08, 0x10, 0x1e, 0x11, 0x11, 0x0e } },
+			{ L'7', { 0x1f, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 } },
+			{ L'8', { 0x0e, 0x11, 0x11, 0x0e, 0x11, 0x11, 0x0e } },
+			{ L'9', { 0x0e, 0x11, 0x11, 0x0f, 0x01, 0x02, 0x0c } },
+			{ L'A', { 0x0e, 0x11, 0x11, 0x1f, 0x11, 0x11, 0x11 } },
+			{ L'B', { 0x1e, 0x11, 0x11, 0x1e, 0x11, 0x11, 0x1e } },
+			{ L'C', { 0x0e, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0e } },
+			{ L'D', { 0x1c, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1c } },
+			{ L'E', { 0x1f, 0x10, 0x10, 0x1e, 0x10, 0x10, 0x1f } },
+			{ L'F', { 0x1f, 0x10, 0x10, 0x1e, 0x10, 0x10, 0x10 } },
+			{ L'X', { 0x11, 0x11, 0x0a, 0x04, 0x0a, 0x11, 0x11 } },
+			{ L'Y', { 0x11, 0x11, 0x0a, 0x04, 0x04, 0x04, 0x04 } },
+			{ L'Z', { 0x1f, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1f } },
+			{ L'o', { 0x00, 0x00, 0x0e, 0x11, 0x11, 0x11, 0x0e } },
+			{ L'm', { 0x00, 0x00, 0x1a, 0x15, 0x15, 0x11, 0x11 } },
+			{ L'x', { 0x00, 0x00, 0x11, 0x0a, 0x04, 0x0a, 0x11 } },
+			{ L'#', { 0x0a, 0x0a, 0x1f, 0x0a, 0x1f, 0x0a, 0x0a } },
+			{ L':', { 0x00, 0x0c, 0x0c, 0x00, 0x0c, 0x0c, 0x00 } },
+			{ L',', { 0x00, 0x00, 0x00, 0x00, 0x0c, 0x04, 0x08 } },
+			{ L'.', { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0c, 0x0c } },
+			{ L'-', { 0x00, 0x00, 0x00, 0x1f, 0x00, 0x00, 0x00 } },
+			{ L' ', { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 } },
+		};
+		for (auto const& e : table) {
+			if (e.c != c) continue;
+			for (int i = 0; i < 7; i++) rows[i] = e.rows[i];
+			return;
+		}
+		test_util::Rng rng{ 0x9e3779b9u * (static_cast<uint32_t>(c) + 1) };
+		for (auto& r : rows) r = static_cast<uint8_t>(rng() & 0x1f);
+	}
+
+	// fills the image with smooth gradations in each channel.
+	inline void fill_gradient(Image& img)
+	{
+		int const w = img.view.width, h = img.view.height;
+		for (int y = 0; y < h; y++) {
+			for (int x = 0; x < w; x++) {
+				auto const p = img.at(x, y);
+				p[0] = static_cast<byte>(255 * (x + y) / std::max(w + h - 2, 1));
+				p[1] = static_cast<byte>(255 * y / std::max(h - 1, 1));
+				p[2] = static_cast<byte>(255 * x / std::max(w - 1, 1));
+			}
+		}
+	}
+
+	// draws `str` with the dots magnified by `scale` in the color, with hard edges.
+	inline void draw_dots(Image& img, int left, int top, int scale, const wchar_t* str, uint32_t colorref)
+	{
+		for (int k = 0; str[k] != L'\0'; k++) {
+			uint8_t rows[7];
+			dots_of(str[k], rows);
+			for (int j = 0; j < 7 * scale; j++) {
+				for (int i = 0; i < 5 * scale; i++) {
+					int const x = left + 6 * scale * k + i, y = top + j;
+					if (x < 0 || x >= img.view.width || y < 0 || y >= img.view.height) continue;
+					if (((rows[j / scale] >> (4 - i / scale)) & 1) == 0) continue;
+					auto const p = img.at(x, y);
+					p[0] = static_cast<byte>(colorref >> 16); p[1] = static_cast<byte>(colorref >> 8); p[2] = static_cast<byte>(colorref);
+				}
+			}
+		}
+	}
+
+	// fills the image with rows of text in black and white over the gradations.
+	inline void fill_text_edges(Image& img, int scale = 1)
+	{
+		fill_gradient(img);
+		constexpr wchar_t line[] = L"0123456789ABCDEF#XYZ:,.-";
+		int const line_h = 9 * scale, line_w = 6 * scale * (static_cast<int>(std::size(line)) - 1);
+		for (int y = 1, n = 0; y < img.view.height; y += line_h, n++) {
+			for (int x = 1 - (n * 7 * scale) % line_w; x < img.view.width; x += line_w)
+				draw_dots(img, x, y, scale, line, (n & 1) != 0 ? 0xffffff : 0x000000);
+		}
+	}
+
+	// the kinds of the frames for the benchmarks.
+	enum class Kind { gradient, noise, text };
+	constexpr const char* name_of(Kind kind) {
+		return kind == Kind::gradient ? "gradient" : kind == Kind::noise ? "noise" : "text";
+	}
+	inline Image make(Kind kind, int width, int height, uint32_t seed = 1)
+	{
+		Image img{ width, height };
+		switch (kind) {
+		case Kind::gradient: fill_gradient(img); break;
+		case Kind::noise: test_util::fill_noise(img, seed); break;
+		case Kind::text: fill_text_edges(img, std::max(height / 360, 1)); break;
+		}
+		return img;
+	}
+
+	// a small frame with all the kinds side by side: gradations, noise, and text over the gradations.
+	inline Image make_mixed(int width, int height, uint32_t seed = 1)
+	{
+		Image img{ width, height }, grad{ width, height }, noise{ width, height };
+		fill_text_edges(img);
+		fill_gradient(grad);
+		test_util::fill_noise(noise, seed);
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < 2 * width / 3; x++) {
+				auto const s = (x < width / 3 ? grad : noise).at(x, y), d = img.at(x, y);
+				d[0] = s[0]; d[1] = s[1]; d[2] = s[2];
+			}
+		}
+		return img;
+	}
+}
@@ -0,0 +1,347 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "test_util.hpp"
+#include "frames.hpp"
+#include "canvas.hpp"
+#include "upscale.hpp"
+#include "grid_raster.hpp"
+#include "chrome_sprite.hpp"
+#include "glyph_atlas.hpp"
+#include "overlay.hpp"
+#include "loupe_view.hpp"
+#include "text_format.hpp"
+
+// renders the views of the loupe by draw_picture() and the others of the plugin, through RasterCanvas,
+// and compares them with the reference images in the directory given.
+// usage: test_golden <dir> [--update] [--tolerance N]
+//   --update: writes the rendered images as the new references.
+//   --tolerance: the largest difference allowed in each channel of each pixel (default 2).
+
+using namespace sigma_lib::image;
+using test_util::Image;
+
+////////////////////////////////
+// 参照画像の入出力．
+////////////////////////////////
+
+// writes the image as a binary PPM, from the top row.
+static bool write_ppm(const std::string& path, const Image& img)
+{
+	FILE* fp = std::fopen(path.c_str(), "wb");
+	if (fp == nullptr) return false;
+	std::fprintf(fp, "P6\n%d %d\n255\n", img.view.width, img.view.height);
+	std::vector<byte> line(3 * static_cast<size_t>(img.view.width));
+	for (int y = 0; y < img.view.height; y++) {
+		for (int x = 0; x < img.view.width; x++) {
+			auto const p = img.at(x, y);
+			line[3 * x] = p[2]; line[3 * x + 1] = p[1]; line[3 * x + 2] = p[0];
+		}
+		std::fwrite(line.data(), 1, line.size(), fp);
+	}
+	return std::fclose(fp) == 0;
+}
+
+// reads a binary PPM written by write_ppm() into a 24bpp image.
+static bool read_ppm(const std::string& path, Image& img)
+{
+	FILE* fp = std::fopen(path.c_str(), "rb");
+	if (fp == nullptr) return false;
+	int w = 0, h = 0, max = 0;
+	bool ok = std::fscanf(fp, "P6 %d %d %d", &w, &h, &max) == 3 && max == 255 &&
+		w > 0 && h > 0 && std::fgetc(fp) != EOF;
+	if (ok) {
+		img = Image{ w, h };
+		std::vector<byte> line(3 * static_cast<size_t>(w));
+		for (int y = 0; ok && y < h; y++) {
+			ok = std::fread(line.data(), 1, line.size(), fp) == line.size();
+			for (int x = 0; ok && x < w; x++) {
+				auto const p = img.at(x, y);
+				p[2] = line[3 * x]; p[1] = line[3 * x + 1]; p[0] = line[3 * x + 2];
+			}
+		}
+	}
+	std::fclose(fp);
+	return ok;
+}
+
+static struct {
+	std::string dir;
+	bool update = false;
+	int tolerance = 2;
+} options;
+
+// compares the image with the reference of the name, reporting the tiles of `tile_w` x `tile_h` that differ.
+// `label(i)` names the `i`-th tile from the top-left, row by row.
+static void compare(const char* name, const Image& img, int tile_w, int tile_h, auto&& label)
+{
+	auto const path = options.dir + "/" + name + ".ppm";
+	if (options.update) {
+		CHECK(write_ppm(path, img));
+		return;
+	}
+
+	Image ref{ 1, 1 };
+	if (!CHECK(read_ppm(path, ref))) {
+		std::fprintf(stderr, "  missing reference: %s\n", path.c_str());
+		write_ppm(std::string{ name } + ".actual.ppm", img);
+		return;
+	}
+	if (!CHECK(ref.view.width == img.view.width && ref.view.height == img.view.height)) return;
+
+	int const cols = img.view.width / tile_w;
+	std::vector<int> bad(static_cast<size_t>(cols * (img.view.height / tile_h)), 0);
+	int num_bad = 0;
+	for (int y = 0; y < img.view.height; y++) {
+		for (int x = 0; x < img.view.width; x++) {
+			auto const p = img.at(x, y), q = ref.at(x, y);
+			int diff = 0;
+			for (int k = 0; k < 3; k++) diff = std::max(diff, std::abs(p[k] - q[k]));
+			if (diff <= options.tolerance) continue;
+			num_bad++;
+			bad[(y / tile_h) * cols + x / tile_w]++;
+		}
+	}
+	if (!CHECK(num_bad == 0)) {
+		std::fprintf(stderr, "  %s: %d pixel(s) differ by more than %d\n", name, num_bad, options.tolerance);
+		for (size_t i = 0; i < bad.size(); i++) {
+			if (bad[i] > 0) std::fprintf(stderr, "    %s: %d pixel(s)\n", label(static_cast<int>(i)).c_str(), bad[i]);
+		}
+		write_ppm(std::string{ name } + ".actual.ppm", img);
+	}
+}
+
+////////////////////////////////
+// 描画．
+////////////////////////////////
+
+// the colors of the default scheme, in COLORREF.
+constexpr uint32_t
+	color_chrome = 0x767676, color_back_top = 0xffffff, color_back_bottom = 0xf7ece4,
+	color_text = 0x3f3d3b, color_blank = 0xf0f0f0;
+constexpr uint32_t grid_thick_colors[] = { 0x222222, 0x444444, 0x666666, 0x999999, 0xbbbbbb, 0xdddddd };
+
+// the picture shown in the tests.
+constexpr int picture_w = 48, picture_h = 32;
+
+// draws the glyphs of the 5x7 dots in white on black, with a faint fringe on their sides.
+static bool build_glyphs(GlyphAtlas& atlas)
+{
+	constexpr int height = 10;
+	GlyphAtlas::Glyph layout[GlyphAtlas::num_glyphs];
+	for (auto& g : layout) g = { .x = 0, .left = -1, .width = 7, .advance = 6 };
+	int const width = GlyphAtlas::layout(layout);
+
+	Image strip{ width, height };
+	for (int i = 0; i < GlyphAtlas::num_glyphs; i++) {
+		uint8_t rows[7];
+		test_frames::dots_of(static_cast<wchar_t>(GlyphAtlas::first_char + i), rows);
+		for (int j = 0; j < 7; j++) {
+			for (int k = -1; k <= 5; k++) {
+				auto const on = [&](int b) { return 0 <= b && b < 5 && ((rows[j] >> (4 - b)) & 1) != 0; };
+				int const v = on(k) ? 255 : on(k - 1) || on(k + 1) ? 64 : 0;
+				auto const p = strip.at(layout[i].x + 1 + k, 1 + j);
+				p[0] = p[1] = p[2] = static_cast<byte>(v);
+			}
+		}
+	}
+	return atlas.build(layout, height, strip.view);
+}
+
+static struct Renderer {
+	Upscaler upscaler{};
+	MipPyramid mipmap{};
+	GridRaster grid{};
+	ChromeSprites chrome{};
+	GlyphAtlas glyphs{};
+
+	// draws the picture and the grid as draw() of the loupe does without the layers,
+	// onto 32bpp pixels as the back buffer is. zoomed out, `mip` draws from the mipmap.
+	void picture(Image& dst, const ImageView& src, const LoupeZoom& zoom, double x, double y, uint8_t grid_thick,
+		bool mip = false)
+	{
+		auto const [vb, vp] = viewbox_viewport(zoom, x, y, src.width, src.height, dst.view.width, dst.view.height);
+		auto const rc = Rect::of_size(dst.view.width, dst.view.height);
+		RasterCanvas canvas{ dst.view };
+
+		int mip_level = 0;
+		if (mip && zoom.zoom_level < 0) {
+			auto const [n, d] = zoom.scale_ratio_Q();
+			mip_level = MipPyramid::level_for(n, d);
+			if (mip_level > 0) mipmap.prepare(src.bits, src.width, src.height, vb);
+		}
+
+		if (!vp.contains(rc)) draw_backplane(canvas, rc, color_blank);
+		if (zoom.zoom_level > 0) draw_picture_upscaled(canvas, upscaler, { src }, rc, vb, vp, nullptr);
+		else draw_picture(canvas, { src }, vb, vp, mipmap, mip_level);
+
+		if (grid_thick > 0) grid.draw(dst.view, vb, vp, grid_thick, grid_thick_colors);
+	}
+
+	// draws the tip for the pixel at (`px`, `py`) as draw_tip() does with the hexadecimal color format.
+	void tip(Image& dst, const ImageView& src, const LoupeZoom& zoom, double x, double y,
+		int px, int py, bool centered, bool& prefer_above)
+	{
+		int const cw = dst.view.width, ch = dst.view.height;
+		auto const s = zoom.scale_ratio();
+		double const bx = s * (px - x) + cw / 2.0, by = s * (py - y) + ch / 2.0;
+		Rect const box{
+			static_cast<int>(std::floor(bx)), static_cast<int>(std::floor(by)),
+			static_cast<int>(std::ceil(bx + s)), static_cast<int>(std::ceil(by + s)),
+		};
+
+		// the pixel box.
+		const byte* const p = src.row(py) + 3 * px;
+		uint32_t const color = p[2] | (p[1] << 8) | (p[0] << 16);
+		RasterCanvas canvas{ dst.view };
+		overlay::draw_pixel_box(canvas, box.inflate(4, 4), color,
+			77 * p[2] + 151 * p[1] + 29 * p[0] <= 65535 / 2 ? 0xffffff : 0x000000);
+
+		// the text.
+		using namespace sigma_lib::format;
+		wchar_t str[64];
+		int len = 0;
+		str[len++] = L'#';
+		len += put_hex6(str + len, (p[2] << 16) | (p[1] << 8) | p[0], true);
+		str[len++] = L'\n';
+		len += overlay::put_coord(str + len, px, py, src.width, src.height, centered);
+		str[len] = L'\0';
+
+		auto const [w, h] = glyphs.measure(str, len);
+		auto const layout = overlay::place_tip(box, w, h, cw, ch, 10, { 4, 4, 10, 3 }, prefer_above);
+		chrome_and_text(dst, layout, 1, true, str, len);
+	}
+
+	// draws the toast at the placement as draw_toast() does.
+	void toast(Image& dst, const wchar_t* message, int placement)
+	{
+		int const len = static_cast<int>(std::wcslen(message));
+		auto const [w, h] = glyphs.measure(message, len);
+		auto const layout = overlay::place_toast(w, h, dst.view.width, dst.view.height,
+			placement % 3 - 1, placement / 3 - 1, { 4, 4, 6, 4 });
+		chrome_and_text(dst, layout, 1, false, message, len);
+	}
+
+	void chrome_and_text(Image& dst, const overlay::Layout& layout, int thick, bool center, const wchar_t* str, int len)
+	{
+		CHECK(chrome.draw(dst.view, layout.frame.left, layout.frame.top, {
+			.width = layout.frame.width(), .height = layout.frame.height(), .corner = 8, .thick = thick,
+			.back_top = color_back_top, .back_bottom = color_back_bottom, .chrome = color_chrome }));
+		glyphs.draw(dst.view, layout.text.left, layout.text.top, layout.text.width(), center, str, len, color_text);
+	}
+} renderer;
+
+////////////////////////////////
+// 各テスト．
+////////////////////////////////
+
+// every zoom level, in a sheet of tiles for each of the grid off, thin and thick.
+static void test_zoom_levels(const ImageView& src)
+{
+	constexpr int tile_w = 48, tile_h = 36, cols = 7,
+		num_levels = LoupeZoom::zoom_level_max - LoupeZoom::zoom_level_min + 1,
+		rows = (num_levels + cols - 1) / cols;
+	constexpr const char* names[] = { "zoom_grid_off", "zoom_grid_thin", "zoom_grid_thick" };
+
+	for (uint8_t thick = 0; thick <= 2; thick++) {
+		Image sheet{ cols * tile_w, rows * tile_h, 4 };
+		for (int i = 0; i < num_levels; i++) {
+			// render into a tile of the sheet.
+			Image tile{ tile_w, tile_h, 4 };
+			renderer.picture(tile, src, { LoupeZoom::zoom_level_min + i, 0 }, 20.5, 13.25, thick);
+			for (int y = 0; y < tile_h; y++)
+				std::memcpy(sheet.at((i % cols) * tile_w, (i / cols) * tile_h + y), tile.at(0, y), 4 * tile_w);
+		}
+		compare(names[thick], sheet, tile_w, tile_h, [](int i) {
+			return "zoom level " + std::to_string(LoupeZoom::zoom_level_min + i);
+		});
+	}
+
+	// the zoomed-out levels again, drawn from the mipmap.
+	constexpr int num_mip = -LoupeZoom::zoom_level_min, mip_rows = (num_mip + cols - 1) / cols;
+	Image sheet{ cols * tile_w, mip_rows * tile_h, 4 };
+	for (int i = 0; i < num_mip; i++) {
+		Image tile{ tile_w, tile_h, 4 };
+		renderer.picture(tile, src, { LoupeZoom::zoom_level_min + i, 0 }, 20.5, 13.25, 0, true);
+		for (int y = 0; y < tile_h; y++)
+			std::memcpy(sheet.at((i % cols) * tile_w, (i / cols) * tile_h + y), tile.at(0, y), 4 * tile_w);
+	}
+	compare("zoom_mipmap", sheet, tile_w, tile_h, [](int i) {
+		return "zoom level " + std::to_string(LoupeZoom::zoom_level_min + i) + " by the mipmap";
+	});
+}
+
+// the tip in each of the coordinate formats, placed below the pixel and then flipped above it.
+static void test_tip(const ImageView& src)
+{
+	constexpr const char* names[] = { "tip_origin_top_left", "tip_origin_center" };
+	for (int fmt = 0; fmt < 2; fmt++) {
+		Image img{ 128, 96, 4 };
+		LoupeZoom const zoom{ 12, 0 };
+		renderer.picture(img, src, zoom, 22.5, 15.5, 2);
+
+		bool prefer_above = false;
+		renderer.tip(img, src, zoom, 22.5, 15.5, 22, 15, fmt == 1, prefer_above);
+		CHECK(!prefer_above);
+		renderer.tip(img, src, zoom, 22.5, 15.5, 24, 17, fmt == 1, prefer_above);
+		CHECK(prefer_above);
+		compare(names[fmt], img, img.view.width, img.view.height, [&](int) { return std::string{ names[fmt] }; });
+	}
+}
+
+// the toast at every placement.
+static void test_toast(const ImageView& src)
+{
+	constexpr const char* names[] = {
+		"toast_top_left", "toast_top", "toast_top_right",
+		"toast_left", "toast_center", "toast_right",
+		"toast_bottom_left", "toast_bottom", "toast_bottom_right",
+	};
+	for (int placement = 0; placement < 9; placement++) {
+		Image img{ 128, 96, 4 };
+		renderer.picture(img, src, { 8, 0 }, 24, 16, 0);
+		renderer.toast(img, L"Zoom x4.00", placement);
+		compare(names[placement], img, img.view.width, img.view.height,
+			[&](int) { return std::string{ names[placement] }; });
+	}
+}
+
+int main(int argc, char** argv)
+{
+	for (int i = 1; i < argc; i++) {
+		if (std::strcmp(argv[i], "--update") == 0) options.update = true;
+		else if (std::strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) options.tolerance = std::atoi(argv[++i]);
+		else options.dir = argv[i];
+	}
+	if (options.dir.empty()) {
+		std::fprintf(stderr, "usage: test_golden <dir> [--update] [--tolerance N]\n");
+		return 2;
+	}
+
+	if (!CHECK(build_glyphs(renderer.glyphs))) return test_util::result("golden");
+	auto const frame = test_frames::make_mixed(picture_w, picture_h, 5);
+	test_zoom_levels(frame.view);
+	test_tip(frame.view);
+	test_toast(frame.view);
+	return test_util::result(options.update ? "golden (updated)" : "golden");
+}
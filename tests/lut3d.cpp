@@ -0,0 +1,123 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <tuple>
+#include <cmath>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "test_util.hpp"
+#include "lut3d.hpp"
+
+using namespace sigma_lib::image;
+
+// the text of a .cube file of `n` points, with the output of `f(r, g, b)` for the inputs in [0, 1].
+static std::string cube_text(int n, auto&& f)
+{
+	std::string ret = "TITLE \"test\"\nLUT_3D_SIZE " + std::to_string(n) + "\n";
+	char line[64];
+	for (int b = 0; b < n; b++) for (int g = 0; g < n; g++) for (int r = 0; r < n; r++) {
+		auto const [R, G, B] = f(r / (n - 1.0), g / (n - 1.0), b / (n - 1.0));
+		std::snprintf(line, sizeof(line), "%.6f %.6f %.6f\n", R, G, B);
+		ret += line;
+	}
+	return ret;
+}
+
+// the identity maps every color to itself.
+static void test_identity()
+{
+	for (int n : { 2, 17, 33 }) {
+		auto const text = cube_text(n, [](double r, double g, double b) { return std::tuple{ r, g, b }; });
+		Lut3D lut{};
+		CHECK(lut.load(text.data(), text.size()));
+		int bad = 0;
+		for (int i = 0; i < 1 << 24; i += 97) {
+			byte const src[3] = { static_cast<byte>(i), static_cast<byte>(i >> 8), static_cast<byte>(i >> 16) };
+			byte dst[3];
+			lut.map(src, dst);
+			bad += std::memcmp(src, dst, 3) != 0;
+		}
+		CHECK(bad == 0);
+	}
+}
+
+// the tetrahedral interpolation agrees with one in floating point, for each of the six tetrahedra.
+static void test_tetrahedral()
+{
+	constexpr int n = 9;
+	test_util::Rng rng{ 24 };
+	std::vector<float> lattice(3 * n * n * n);
+	for (auto& v : lattice) v = static_cast<float>(rng() % 1001) / 1000;
+	auto const text = cube_text(n, [&, i = 0](double, double, double) mutable {
+		auto const p = &lattice[3 * i++];
+		return std::tuple{ p[0], p[1], p[2] };
+	});
+	Lut3D lut{};
+	CHECK(lut.load(text.data(), text.size()));
+
+	// the lattice point in R, G, B.
+	auto const at = [&](int r, int g, int b, int c) { return lattice[3 * ((b * n + g) * n + r) + c]; };
+	int worst = 0;
+	for (int k = 0; k < 200000; k++) {
+		byte const src[3] = { static_cast<byte>(rng()), static_cast<byte>(rng()), static_cast<byte>(rng()) };
+		byte dst[3];
+		lut.map(src, dst);
+
+		double x[3]; int i[3];
+		for (int c = 0; c < 3; c++) {
+			x[c] = src[2 - c] / 255.0 * (n - 1);
+			i[c] = std::min(static_cast<int>(x[c]), n - 2);
+			x[c] -= i[c];
+		}
+		// walk from the lower corner along the axes in descending order of the fractions.
+		int order[3] = { 0, 1, 2 };
+		std::sort(order, order + 3, [&](int a, int b) { return x[a] > x[b]; });
+		for (int c = 0; c < 3; c++) {
+			int p[3] = { i[0], i[1], i[2] };
+			double v = (1 - x[order[0]]) * at(p[0], p[1], p[2], c), prev = x[order[0]];
+			for (int s = 0; s < 3; s++) {
+				p[order[s]]++;
+				double const next = s < 2 ? x[order[s + 1]] : 0;
+				v += (prev - next) * at(p[0], p[1], p[2], c);
+				prev = next;
+			}
+			worst = std::max(worst, std::abs(static_cast<int>(std::lround(255 * v)) - dst[2 - c]));
+		}
+	}
+	CHECK(worst <= 1);
+}
+
+// invalid files are rejected.
+static void test_invalid()
+{
+	Lut3D lut{};
+	for (std::string text : { "", "LUT_3D_SIZE 2\n0 0 0\n", "LUT_3D_SIZE 1\n0 0 0\n", "LUT_1D_SIZE 2\n0 0 0\n1 1 1\n" }) {
+		CHECK(!lut.load(text.data(), text.size()));
+		CHECK(!lut.is_loaded());
+	}
+}
+
+int main()
+{
+	test_identity();
+	test_tetrahedral();
+	test_invalid();
+	return test_util::result("lut3d");
+}
@@ -0,0 +1,288 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+#include <cstdint>
+#include <cstring>
+
+#include "test_util.hpp"
+#include "canvas.hpp"
+#include "upscale.hpp"
+#include "grid_raster.hpp"
+#include "grid_lines.hpp"
+#include "loupe_view.hpp"
+
+using namespace sigma_lib::image;
+using test_util::Image;
+
+// the pixels in the 4th bytes of 32bpp images must be left as they were.
+static bool padding_intact(const Image& img, byte value)
+{
+	for (int y = 0; y < img.view.height; y++)
+		for (int x = 0; x < img.view.width; x++)
+			if (img.at(x, y)[3] != value) return false;
+	return true;
+}
+
+static void test_fill_invert(int depth)
+{
+	Image img{ 13, 7, depth };
+	std::memset(img.pixels.data(), 0x5a, img.pixels.size());
+	RasterCanvas canvas{ img.view };
+
+	// clipped to the canvas.
+	canvas.fill_rect({ -4, 2, 5, 100 }, 0x00123456);
+	for (int y = 0; y < 7; y++) for (int x = 0; x < 13; x++)
+		CHECK(img.colorref(x, y) == (x < 5 && y >= 2 ? 0x00123456u : 0x005a5a5au));
+
+	// inverting twice restores the pixels.
+	Image const before = img;
+	canvas.invert_rect({ 3, 1, 20, 6 });
+	CHECK(img.colorref(3, 2) == (~0x00123456u & 0x00ffffff));
+	CHECK(img.colorref(2, 1) == before.colorref(2, 1));
+	canvas.invert_rect({ 3, 1, 20, 6 });
+	CHECK(test_util::same_pixels(img, before));
+
+	// empty rects draw nothing.
+	canvas.fill_rect({ 5, 5, 5, 6 }, 0);
+	canvas.fill_rect({ 20, 0, 30, 7 }, 0);
+	CHECK(test_util::same_pixels(img, before));
+
+	if (depth == 4) CHECK(padding_intact(img, 0x5a));
+}
+
+// stretching and drawing the upscaled image agree, on either depth,
+// and both map the source pixels to the spans of the grid, at non-integer ratios too.
+static void test_stretch_vs_upscale(int depth)
+{
+	Image src{ 37, 23 };
+	test_util::fill_noise(src, 7);
+	Upscaler upscaler{};
+
+	struct { Rect vb, vp, clip; } const cases[] = {
+		{ { 0, 0, 37, 23 }, { 0, 0, 37, 23 }, { 0, 0, 200, 150 } },
+		{ { 3, 2, 20, 14 }, { -5, 4, 5 * 17 - 5, 4 + 5 * 12 }, { 0, 0, 200, 150 } },
+		{ { 1, 1, 30, 20 }, { 2, -3, 2 + 29 * 7 / 2, -3 + 19 * 7 / 2 }, { 0, 0, 101, 67 } },
+		{ { 10, 5, 17, 12 }, { 40, 30, 40 + 7 * 24, 30 + 7 * 24 }, { 50, 35, 200, 150 } },
+	};
+	for (auto const& c : cases) {
+		Image a{ 200, 150, depth }, b{ 200, 150, depth };
+		std::memset(a.pixels.data(), 0x33, a.pixels.size());
+		std::memset(b.pixels.data(), 0x33, b.pixels.size());
+
+		RasterCanvas ca{ a.view }, cb{ b.view };
+		// stretch_image() draws the whole view port; clip it the same way the window does.
+		Image clipped = a;
+		RasterCanvas cc{ clipped.view };
+		cc.stretch_image(c.vp, src.view, c.vb);
+		for (int y = 0; y < 150; y++) for (int x = 0; x < 200; x++) {
+			if (!c.clip.contains(x, y)) continue;
+			auto const s = clipped.at(x, y); auto const d = a.at(x, y);
+			d[0] = s[0]; d[1] = s[1]; d[2] = s[2];
+		}
+
+		// each source pixel covers the span [i * W / w, (i + 1) * W / w) the grid lines bound.
+		auto const span_of = [](int X, int n, int N) {
+			int i = 0;
+			while ((i + 1) * N / n <= X) i++;
+			return i;
+		};
+		bool spans = true;
+		auto const in_vp = c.vp & Rect::of_size(200, 150);
+		for (int y = in_vp.top; y < in_vp.bottom; y++) for (int x = in_vp.left; x < in_vp.right; x++) {
+			int const sx = c.vb.left + span_of(x - c.vp.left, c.vb.width(), c.vp.width()),
+				sy = c.vb.top + span_of(y - c.vp.top, c.vb.height(), c.vp.height());
+			spans &= std::memcmp(clipped.at(x, y), src.at(sx, sy), 3) == 0;
+		}
+		CHECK(spans);
+
+		auto const& out = upscaler.render(src.view, c.vb, c.vp, c.clip);
+		if (out.width > 0)
+			cb.draw_image(std::max(c.vp.left, c.clip.left), std::max(c.vp.top, c.clip.top), out);
+
+		CHECK(test_util::same_pixels(a, b));
+		if (depth == 4) CHECK(padding_intact(b, 0x33));
+	}
+}
+
+// the picture and the grid drawn onto 24bpp and 32bpp pixels look the same.
+static void test_depths_agree()
+{
+	Image src{ 40, 30 };
+	test_util::fill_noise(src, 11);
+	constexpr uint32_t thick_colors[6] = { 0x000000, 0x202020, 0x404040, 0xffffff, 0xdfdfdf, 0xbfbfbf };
+	Rect const vb{ 2, 3, 30, 25 }, vp{ -7, -2, -7 + 28 * 9, -2 + 22 * 9 };
+
+	for (uint8_t thick : { 1, 2 }) {
+		Image a{ 240, 180, 3 }, b{ 240, 180, 4 };
+		GridRaster ga{}, gb{};
+		for (auto* img : { &a, &b }) {
+			RasterCanvas canvas{ img->view };
+			canvas.fill_rect(Rect::of_size(240, 180), 0x00808080);
+			canvas.stretch_image(vp, src.view, vb);
+		}
+		ga.draw(a.view, vb, vp, thick, thick_colors);
+		gb.draw(b.view, vb, vp, thick, thick_colors);
+		CHECK(test_util::same_pixels(a, b));
+	}
+}
+
+// scrolling the previous drawing and filling the exposed strips gives the same as drawing anew.
+static void test_scroll_patch(int depth)
+{
+	Image src{ 53, 41 };
+	test_util::fill_noise(src, 13);
+	constexpr int W = 150, H = 110;
+	constexpr uint32_t blank = 0x00406080;
+	auto const draw_full = [&](RasterCanvas& canvas, const Rect& vb, const Rect& vp) {
+		canvas.fill_rect(Rect::of_size(W, H), blank);
+		canvas.stretch_image(vp, src.view, vb);
+	};
+
+	for (int z : { 0, 4, 8, 13 }) {
+		LoupeZoom const zoom{ z, 0 };
+		auto const [n, d] = zoom.scale_ratio_Q();
+		CHECK(d == 1);
+
+		Image a{ W, H, depth }, b{ W, H, depth };
+		RasterCanvas ca{ a.view }, cb{ b.view };
+		// starts near a corner so the blank area shows, then moves over it and back.
+		double x = 3.5, y = 2.5;
+		auto [vb, vp] = viewbox_viewport(zoom, x, y, 53, 41, W, H);
+		draw_full(ca, vb, vp);
+		for (auto [mx, my] : { std::pair{ 1.0, 0.0 }, { 0.0, 2.0 }, { 3.0, 1.0 }, { 12.0, 7.0 }, { -5.0, -4.0 }, { 0.0, 0.0 } }) {
+			x += mx; y += my;
+			auto const [vb2, vp2] = viewbox_viewport(zoom, x, y, 53, 41, W, H);
+			auto const [dx, dy] = scroll_offset(vb, vp, vb2, vp2, n);
+			CHECK(dx == -n * static_cast<int>(mx) && dy == -n * static_cast<int>(my));
+			vb = vb2; vp = vp2;
+
+			if (std::abs(dx) < W && std::abs(dy) < H) {
+				ca.scroll(dx, dy);
+				auto const [sx, sy] = exposed_strips(dx, dy, W, H);
+				for (auto const& strip : { sx, sy }) {
+					if (strip.is_empty()) continue;
+					ca.fill_rect(strip, blank);
+					auto const [sub_vb, sub_vp] = sub_viewbox_viewport(strip, vb, vp, n);
+					if (!sub_vb.is_empty()) ca.stretch_image(sub_vp, src.view, sub_vb);
+				}
+			}
+			else draw_full(ca, vb, vp);
+			draw_full(cb, vb, vp);
+			CHECK(test_util::same_pixels(a, b));
+		}
+	}
+}
+
+// the grid drawn at once agrees with that drawn line by line, at integer and fractional scales.
+static void test_grid_lines_agree(int depth)
+{
+	Image src{ 40, 30 };
+	test_util::fill_noise(src, 17);
+	constexpr uint32_t thick_colors[6] = { 0x000000, 0x202020, 0x404040, 0xffffff, 0xdfdfdf, 0xbfbfbf };
+	struct { Rect vb, vp; } const cases[] = {
+		{ { 2, 3, 30, 25 }, { -7, -2, -7 + 28 * 9, -2 + 22 * 9 } },
+		{ { 0, 0, 40, 30 }, { 5, 4, 5 + 40 * 6, 4 + 30 * 6 } },
+		{ { 7, 1, 33, 19 }, { -3, 6, -3 + 26 * 7 / 2, 6 + 18 * 7 / 2 } },
+	};
+	for (auto const& c : cases) {
+		for (uint8_t thick : { 1, 2 }) {
+			Image a{ 240, 180, depth }, b{ 240, 180, depth };
+			for (auto* img : { &a, &b }) {
+				RasterCanvas canvas{ img->view };
+				canvas.fill_rect(Rect::of_size(240, 180), 0x00808080);
+				canvas.stretch_image(c.vp, src.view, c.vb);
+			}
+			GridRaster grid{};
+			grid.draw(a.view, c.vb, c.vp, thick, thick_colors);
+			RasterCanvas canvas{ b.view };
+			if (thick == 1) draw_grid_thin(canvas, c.vb, c.vp);
+			else draw_grid_thick(canvas, c.vb, c.vp, thick_colors);
+			CHECK(test_util::same_pixels(a, b));
+		}
+	}
+}
+
+// the adaptive grid draws the lines of the plain one, along with the intersections of the thin grid,
+// dark over the bright source pixels and light over the dark ones or outside the source.
+static void test_grid_adaptive(int depth)
+{
+	Image src{ 40, 30 };
+	test_util::fill_noise(src, 23);
+	constexpr uint32_t thick_colors[6] = { 0x000000, 0x202020, 0x404040, 0xffffff, 0xdfdfdf, 0xbfbfbf };
+	struct { Rect vb; int scale; } const cases[] = {
+		{ { 2, 3, 30, 25 }, 9 },
+		{ { 0, 0, 40, 30 }, 6 },
+		{ { -4, -3, 26, 19 }, 8 },
+	};
+	for (auto const& c : cases) {
+		Rect const vp{ -5, -3, -5 + c.vb.width() * c.scale, -3 + c.vb.height() * c.scale };
+		for (uint8_t thick : { 1, 2 }) {
+			Image a{ 240, 180, depth }, b{ 240, 180, depth };
+			for (auto* img : { &a, &b }) RasterCanvas{ img->view }.fill_rect(Rect::of_size(240, 180), 0x00808080);
+			GridRaster grid{};
+			grid.draw_adaptive(a.view, src.view, c.vb, vp, thick, thick_colors);
+			grid.draw(b.view, c.vb, vp, thick, thick_colors);
+
+			bool ok = true;
+			for (int y = 0; y < 180; y++) for (int x = 0; x < 240; x++) {
+				const byte* pa = a.view.row(y) + depth * x, * pb = b.view.row(y) + depth * x;
+				ok &= pb[0] == 0x80 || pa[0] != 0x80;
+				if (pa[0] == 0x80) continue;
+				int const sx = c.vb.left + (x - vp.left) / c.scale, sy = c.vb.top + (y - vp.top) / c.scale;
+				bool bright = false;
+				if (0 <= sx && sx < src.view.width && 0 <= sy && sy < src.view.height) {
+					const byte* p = src.view.row(sy) + 3 * sx;
+					bright = 77 * p[2] + 151 * p[1] + 29 * p[0] > 65535 / 2;
+				}
+				ok &= (pa[0] < 0x80) == bright;
+			}
+			CHECK(ok);
+		}
+	}
+}
+
+// a canvas on its own pixels.
+static void test_own_pixels()
+{
+	RasterCanvas canvas{};
+	CHECK(canvas.resize(17, 9));
+	CHECK(canvas.width() == 17 && canvas.height() == 9 && canvas.view().depth == 4);
+	canvas.fill_rect(Rect::of_size(17, 9), 0x00abcdef);
+	auto const p = canvas.view().row(8) + 4 * 16;
+	CHECK(p[0] == 0xab && p[1] == 0xcd && p[2] == 0xef);
+
+	// the same size keeps the pixels.
+	CHECK(canvas.resize(17, 9));
+	CHECK(canvas.view().row(8)[4 * 16] == 0xab);
+
+	CHECK(!canvas.resize(0, 9));
+	CHECK(canvas.view().bits == nullptr);
+	canvas.fill_rect({ 0, 0, 10, 10 }, 0);
+	canvas.release();
+}
+
+int main()
+{
+	for (int depth : { 3, 4 }) {
+		test_fill_invert(depth);
+		test_stretch_vs_upscale(depth);
+		test_scroll_patch(depth);
+		test_grid_lines_agree(depth);
+		test_grid_adaptive(depth);
+	}
+	test_depths_agree();
+	test_own_pixels();
+	return test_util::result("raster_canvas");
+}
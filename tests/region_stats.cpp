@@ -0,0 +1,85 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+
+
+
+
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+#include "test_util.hpp"
+#include "region_stats.hpp"
+
+using namespace sigma_lib::image;
+using test_util::Image;
+
+// the statistics by scanning the pixels, by the same formulas as the tables.
+static RegionStats::Stats scan(const Image& img, Rect rc)
+{
+	rc &= Rect::of_size(img.view.width, img.view.height);
+	if (rc.is_empty()) return {};
+	RegionStats::Stats ret{ .count = rc.width() * rc.height() };
+	double const n = ret.count;
+	for (int c = 0; c < 3; c++) {
+		uint64_t sum = 0, sq = 0;
+		byte lo = 255, hi = 0;
+		for (int y = rc.top; y < rc.bottom; y++) for (int x = rc.left; x < rc.right; x++) {
+			byte const v = img.at(x, y)[c];
+			sum += v; sq += v * v;
+			lo = std::min(lo, v); hi = std::max(hi, v);
+		}
+		double const s = static_cast<double>(sum), q = static_cast<double>(sq);
+		ret.mean[c] = static_cast<byte>(std::lround(s / n));
+		ret.deviation10[c] = static_cast<uint16_t>(std::lround(10 * std::sqrt(std::max(q / n - (s / n) * (s / n), 0.0))));
+		ret.min[c] = lo; ret.max[c] = hi;
+	}
+	return ret;
+}
+
+// the tables agree with the scan, for rows of every remainder of the vector steps.
+static void test_query()
+{
+	test_util::Rng rng{ 41 };
+	for (int width : { 1, 5, 6, 7, 13, 130, 301 }) {
+		Image img{ width, 90 };
+		test_util::fill_noise(img, width);
+		// the extremes make the sums of the squares largest.
+		for (int x = 0; x < width; x += 3) std::fill_n(img.at(x, 10), 3, byte{ 255 });
+
+		RegionStats stats{};
+		bool ok = true;
+		for (int k = 0; k < 40; k++) {
+			int const size = 1 + rng() % 33, x = rng() % width, y = rng() % 90;
+			auto const rc = RegionStats::neighborhood(x, y, size);
+			ok &= stats.query(img.view, rc) == scan(img, rc);
+		}
+		CHECK(ok);
+
+		// a change in the area rebuilds the tables.
+		auto const rc = RegionStats::neighborhood(width / 2, 45, 9);
+		stats.query(img.view, rc);
+		img.at(width / 2, 45)[1] ^= 0x80;
+		stats.invalidate(Rect{ width / 2, 45, width / 2 + 1, 46 }, Rect::of_size(width, 90));
+		CHECK(stats.query(img.view, rc) == scan(img, rc));
+	}
+}
+
+int main()
+{
+	test_query();
+	return test_util::result("region_stats");
+}
@@ -0,0 +1,97 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+#include <cstdint>
+#include <atomic>
+#include <vector>
+
+#include "test_util.hpp"
+#include "strip_pool.hpp"
+#include "upscale.hpp"
+
+using namespace sigma_lib::image;
+using test_util::Image;
+
+// runs many short jobs back to back, checking that every task of a job runs exactly once
+// and that none of them runs after run() returned, which would touch the stack of a finished job.
+static void test_back_to_back(int threads, int num_jobs)
+{
+	StripPool strips{};
+	strips.set_threads(threads);
+	std::atomic_int current_job{ -1 }, strays{ 0 }, spin{ 0 };
+	test_util::Rng rng{ static_cast<uint32_t>(threads) * 7919u };
+
+	int bad_counts = 0;
+	for (int job = 0; job < num_jobs; job++) {
+		int const n = 1 + static_cast<int>(rng() % 64);
+		std::vector<std::atomic_int> counts(static_cast<size_t>(n));
+		current_job = job;
+		strips.run(n, [&, job](int i) {
+			if (current_job.load() != job) strays++;
+			counts[i].fetch_add(1);
+			// vary the length of the tasks so the threads interleave differently.
+			for (int k = (37 * i + job) % 32; k > 0; k--) spin.fetch_add(1, std::memory_order_relaxed);
+		});
+		current_job = -1;
+		for (auto& c : counts) bad_counts += c.load() != 1 ? 1 : 0;
+	}
+	CHECK(bad_counts == 0);
+	CHECK(strays.load() == 0);
+}
+
+// changing the number of threads between jobs restarts the pool safely.
+static void test_resize_threads()
+{
+	StripPool strips{};
+	int total = 0;
+	for (int round = 0; round < 200; round++) {
+		strips.set_threads(1 + round % 5);
+		std::atomic_int sum{ 0 };
+		strips.run(17, [&](int i) { sum += i; });
+		total += sum.load() == 17 * 16 / 2 ? 0 : 1;
+		if (round % 7 == 0) strips.release();
+	}
+	CHECK(total == 0);
+}
+
+// the parallel rendering gives the same image as the serial one.
+static void test_upscale_bands()
+{
+	Image src{ 61, 47 };
+	test_util::fill_noise(src, 17);
+	Rect const vb{ 3, 2, 58, 45 }, clip{ 0, 0, 400, 300 };
+	Upscaler serial{}, parallel{};
+	StripPool strips{};
+	strips.set_threads(4);
+
+	int mismatches = 0;
+	for (int k = 0; k < 40; k++) {
+		Rect const vp{ -k, -2 * k, -k + 55 * (2 + k % 7), -2 * k + 43 * (2 + k % 5) };
+		auto const& a = serial.render(src.view, vb, vp, clip);
+		auto const& b = parallel.render(src.view, vb, vp, clip, &strips);
+		if (a.width != b.width || a.height != b.height) { mismatches++; continue; }
+		for (int y = 0; y < a.height; y++)
+			mismatches += std::memcmp(a.row(y), b.row(y), 3 * static_cast<size_t>(a.width)) != 0 ? 1 : 0;
+	}
+	CHECK(mismatches == 0);
+}
+
+int main()
+{
+	for (int threads : { 2, 3, 8 }) test_back_to_back(threads, 20000);
+	test_resize_threads();
+	test_upscale_bands();
+	return test_util::result("strip_pool");
+}
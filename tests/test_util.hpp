@@ -0,0 +1,99 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "image_basics.hpp"
+
+////////////////////////////////
+// テスト用の補助．
+////////////////////////////////
+namespace test_util
+{
+	using namespace sigma_lib::image;
+
+	inline int failures = 0;
+
+	// reports the failure without stopping the test.
+	inline bool check(bool ok, const char* what, const char* file, int line)
+	{
+		if (!ok) {
+			std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, what);
+			failures++;
+		}
+		return ok;
+	}
+#define CHECK(...)	::test_util::check(static_cast<bool>(__VA_ARGS__), #__VA_ARGS__, __FILE__, __LINE__)
+
+	inline int result(const char* name)
+	{
+		if (failures == 0) std::printf("%s: passed\n", name);
+		else std::printf("%s: %d failure(s)\n", name, failures);
+		return failures == 0 ? 0 : 1;
+	}
+
+	// an image owning its pixels.
+	struct Image {
+		std::vector<byte> pixels;
+		ImageView view;
+
+		Image(int width, int height, int depth = 3)
+			: pixels(ImageView::stride_of(width, depth) * height)
+			, view{ pixels.data(), width, height, ImageView::stride_of(width, depth), depth } {}
+		Image(const Image& other) : pixels{ other.pixels }, view{ other.view } { view.bits = pixels.data(); }
+		Image& operator=(const Image& other) {
+			pixels = other.pixels; view = other.view; view.bits = pixels.data();
+			return *this;
+		}
+
+		byte* at(int x, int y) const { return view.row(y) + view.depth * x; }
+		uint32_t colorref(int x, int y) const {
+			auto const p = at(x, y);
+			return p[2] | (p[1] << 8) | (p[0] << 16);
+		}
+	};
+
+	// a small deterministic generator for the test patterns.
+	struct Rng {
+		uint32_t s;
+		uint32_t operator()() { s ^= s << 13; s ^= s >> 17; s ^= s << 5; return s; }
+	};
+
+	// fills 24bpp `img` with noise, keeping the padding bytes intact.
+	inline void fill_noise(Image& img, uint32_t seed)
+	{
+		Rng rng{ seed | 1 };
+		for (int y = 0; y < img.view.height; y++) {
+			for (int x = 0; x < img.view.width; x++) {
+				auto const p = img.at(x, y); auto const r = rng();
+				p[0] = static_cast<byte>(r); p[1] = static_cast<byte>(r >> 8); p[2] = static_cast<byte>(r >> 16);
+			}
+		}
+	}
+
+	// whether the B, G, R of every pixel agree, ignoring the depth.
+	inline bool same_pixels(const Image& a, const Image& b)
+	{
+		if (a.view.width != b.view.width || a.view.height != b.view.height) return false;
+		for (int y = 0; y < a.view.height; y++)
+			for (int x = 0; x < a.view.width; x++)
+				if (a.colorref(x, y) != b.colorref(x, y)) return false;
+		return true;
+	}
+}
@@ -0,0 +1,80 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+#include <cstdint>
+#include <cwchar>
+#include <cstdio>
+
+#include "test_util.hpp"
+#include "text_format.hpp"
+#include "overlay.hpp"
+
+using namespace sigma_lib;
+
+// compares the `n` characters written with the output of swprintf().
+static bool same_as(const wchar_t* buf, int n, const wchar_t* fmt, auto... args)
+{
+	wchar_t ref[64];
+	int const m = std::swprintf(ref, std::size(ref), fmt, args...);
+	return m == n && std::wmemcmp(buf, ref, n) == 0;
+}
+
+static void test_numbers()
+{
+	test_util::Rng rng{ 3 };
+	wchar_t buf[64];
+	for (int i = 0; i < 200000; i++) {
+		// small numbers more often, as the coordinates and the color components are.
+		auto const r = rng();
+		int32_t const v = static_cast<int32_t>(rng()) >> (r % 31);
+		int const width = static_cast<int>(r >> 8) % 8;
+
+		CHECK(same_as(buf, format::put_int(buf, v, width), L"%*d", width, v));
+		CHECK(same_as(buf, format::put_tenths(buf, v, width), L"%*.1f", width, v / 10.0));
+		// the halves are exact in double.
+		CHECK(same_as(buf, format::put_half(buf, v, width), L"%*.*f", width, v & 1, v / 2.0));
+		CHECK(same_as(buf, format::put_hex6(buf, v, true), L"%06X", v & 0xffffff));
+		CHECK(same_as(buf, format::put_hex6(buf, v, false), L"%06x", v & 0xffffff));
+	}
+	// the ends.
+	for (int32_t v : { INT32_MIN, INT32_MIN + 1, -1, 0, 1, INT32_MAX }) {
+		CHECK(same_as(buf, format::put_int(buf, v, 0), L"%d", v));
+		CHECK(same_as(buf, format::put_half(buf, v, 12), L"%*.*f", 12, v & 1, v / 2.0));
+		CHECK(same_as(buf, format::put_tenths(buf, v, 0), L"%.1f", v / 10.0));
+	}
+}
+
+// the coordinates as the tip shows them, against the formats of the original swprintf() calls.
+static void test_coord()
+{
+	test_util::Rng rng{ 4 };
+	wchar_t buf[64];
+	for (int i = 0; i < 100000; i++) {
+		int const w = 1 + rng() % 4100, h = 1 + rng() % 4100,
+			x = static_cast<int>(rng() % (w + 20)) - 10, y = static_cast<int>(rng() % (h + 20)) - 10;
+		CHECK(same_as(buf, image::overlay::put_coord(buf, x, y, w, h, false), L"X:%4d, Y:%4d", x, y));
+
+		constexpr auto width = [](int scr) { return 1 + (scr < 2000 ? 3 : 4) + (2 * (scr & 1)); };
+		CHECK(same_as(buf, image::overlay::put_coord(buf, x, y, w, h, true), L"X:%*.*f, Y:%*.*f",
+			width(w), w & 1, x - w / 2.0, width(h), h & 1, y - h / 2.0));
+	}
+}
+
+int main()
+{
+	test_numbers();
+	test_coord();
+	return test_util::result("text_format");
+}
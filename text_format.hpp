@@ -0,0 +1,132 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+
+#pragma once
+
+#include <cstdint>
+#include <array>
+#include <algorithm>
+
+////////////////////////////////
+// 数値の文字列化．
+////////////////////////////////
+namespace sigma_lib::format
+{
+	// writes numbers in the same way as the printf family for the few formats the tips and clipboards use,
+	// without locales or heap allocations. the buffers must be large enough, and no null is appended.
+	namespace details
+	{
+		// "00", "01", ..., "99".
+		constexpr auto digit_pairs = [] {
+			std::array<wchar_t, 200> ret{};
+			for (int i = 0; i < 100; i++) {
+				ret[2 * i] = static_cast<wchar_t>(L'0' + i / 10);
+				ret[2 * i + 1] = static_cast<wchar_t>(L'0' + i % 10);
+			}
+			return ret;
+		}();
+		constexpr wchar_t hex_upper[] = L"0123456789ABCDEF", hex_lower[] = L"0123456789abcdef";
+
+		// writes the decimal digits of `u` backward, ending right before `end`. returns the first digit.
+		constexpr wchar_t* digits_backward(wchar_t* end, uint32_t u)
+		{
+			while (u >= 100) {
+				auto const i = 2 * (u % 100); u /= 100;
+				*--end = digit_pairs[i + 1];
+				*--end = digit_pairs[i];
+			}
+			if (u >= 10) {
+				*--end = digit_pairs[2 * u + 1];
+				*--end = digit_pairs[2 * u];
+			}
+			else *--end = static_cast<wchar_t>(L'0' + u);
+			return end;
+		}
+
+		// copies [`first`, `last`) right-aligned to `width` with spaces. returns the length.
+		constexpr int pad_copy(wchar_t* buf, const wchar_t* first, const wchar_t* last, int width)
+		{
+			int const n = static_cast<int>(last - first), pad = std::max(width - n, 0);
+			std::fill_n(buf, pad, L' ');
+			std::copy(first, last, buf + pad);
+			return pad + n;
+		}
+	}
+
+	// copies `str` without the null. returns the length.
+	constexpr int put(wchar_t* buf, const wchar_t* str)
+	{
+		int n = 0;
+		for (; str[n] != L'\0'; n++) buf[n] = str[n];
+		return n;
+	}
+
+	// same as "%*d".
+	constexpr int put_int(wchar_t* buf, int32_t val, int width = 0)
+	{
+		wchar_t tmp[16];
+		auto const end = std::end(tmp);
+		auto p = details::digits_backward(end, val < 0 ? 0u - static_cast<uint32_t>(val) : static_cast<uint32_t>(val));
+		if (val < 0) *--p = L'-';
+		return details::pad_copy(buf, p, end, width);
+	}
+
+	// same as "%*.*f" for `twice / 2.0` with the precision `twice & 1`,
+	// that is, integers without the decimal point and the halves with ".5".
+	constexpr int put_half(wchar_t* buf, int32_t twice, int width = 0)
+	{
+		if ((twice & 1) == 0) return put_int(buf, twice / 2, width);
+
+		wchar_t tmp[16];
+		auto const end = std::end(tmp);
+		end[-2] = L'.'; end[-1] = L'5';
+		auto const abs = twice < 0 ? 0u - static_cast<uint32_t>(twice) : static_cast<uint32_t>(twice);
+		auto p = details::digits_backward(end - 2, abs >> 1);
+		if (twice < 0) *--p = L'-';
+		return details::pad_copy(buf, p, end, width);
+	}
+
+	// same as "%*.1f" for `tenths / 10.0`.
+	constexpr int put_tenths(wchar_t* buf, int32_t tenths, int width = 0)
+	{
+		wchar_t tmp[16];
+		auto const end = std::end(tmp);
+		auto const abs = tenths < 0 ? 0u - static_cast<uint32_t>(tenths) : static_cast<uint32_t>(tenths);
+		end[-2] = L'.'; end[-1] = static_cast<wchar_t>(L'0' + abs % 10);
+		auto p = details::digits_backward(end - 2, abs / 10);
+		if (tenths < 0) *--p = L'-';
+		return details::pad_copy(buf, p, end, width);
+	}
+
+	// same as "%06X" or "%06x" for the lower 24 bits.
+	constexpr int put_hex6(wchar_t* buf, uint32_t val, bool upper)
+	{
+		auto const digits = upper ? details::hex_upper : details::hex_lower;
+		for (int i = 5; i >= 0; i--, val >>= 4) buf[i] = digits[val & 15];
+		return 6;
+	}
+
+	static_assert([] {
+		wchar_t buf[16]{};
+		auto const eq = [&](int n, const wchar_t* s) {
+			for (int i = 0; i < n; i++) if (buf[i] != s[i]) return false;
+			return s[n] == L'\0';
+		};
+		return eq(put_int(buf, -1234, 6), L" -1234") && eq(put_int(buf, 7, 3), L"  7") &&
+			eq(put_half(buf, -1, 5), L" -0.5") && eq(put_half(buf, 201, 0), L"100.5") &&
+			eq(put_half(buf, -8, 3), L" -4") && eq(put_hex6(buf, 0xa0b1c2, true), L"A0B1C2") &&
+			eq(put_tenths(buf, 7, 5), L"  0.7") && eq(put_tenths(buf, -1234, 0), L"-123.4");
+	}());
+}
@@ -0,0 +1,231 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2024 sigma-axis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the “Software”), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+#include "image_basics.hpp"
+#include "frame_alloc.hpp"
+#include "strip_pool.hpp"
+
+////////////////////////////////
+// 拡大表示用の最近傍補間．
+////////////////////////////////
+namespace sigma_lib::image
+{
+	// maps each source index to the span of destination indices it covers.
+	// source `i` covers [start(i), start(i + 1)), which is the same rounding as the grid lines.
+	class SpanMap {
+		FrameAllocator pool{};
+		int src_len = 0, dst_len = 0;
+		int* starts = nullptr;
+
+	public:
+		// returns the map for the lengths, recalculated only when they change,
+		// or nullptr if the memory couldn't be allocated.
+		const int* get(int src, int dst)
+		{
+			if (starts == nullptr || src != src_len || dst != dst_len) {
+				starts = static_cast<int*>(pool.allocate((src + 1) * sizeof(int)));
+				if (starts == nullptr) {
+					src_len = dst_len = 0;
+					return nullptr;
+				}
+				src_len = src; dst_len = dst;
+				for (int i = 0; i <= src; i++)
+					starts[i] = static_cast<int>(static_cast<int64_t>(i) * dst / src);
+			}
+			return starts;
+		}
+		void release() { pool.release(); starts = nullptr; src_len = dst_len = 0; }
+	};
+
+	// renders a part of the image magnified by nearest neighbor,
+	// into a private image that can be drawn to the device as is.
+	class Upscaler {
+		FrameAllocator pool{};
+		SpanMap cols{}, rows{};
+		ImageView out{};
+
+		// vector stores may run over the end of the run by this amount at most.
+		constexpr static size_t overrun = 128;
+		// bands for parallel rendering have at least this number of rows.
+		constexpr static int min_band_rows = 32;
+
+		// fills `n` pixels from `dst` with the pixel `px` (0xRRGGBB).
+		// might write beyond the `n` pixels, up to `overrun` bytes.
+		static void fill(byte* dst, uint32_t px, int n)
+		{
+		#ifdef SIGMA_LIB_IMAGE_SSE2
+			// repeating pattern of 16 pixels in 3 vectors.
+			__m128i p0 = _mm_cvtsi32_si128(static_cast<int>(px));
+			p0 = _mm_or_si128(p0, _mm_slli_si128(p0, 3));
+			p0 = _mm_or_si128(p0, _mm_slli_si128(p0, 6));
+			p0 = _mm_or_si128(p0, _mm_slli_si128(p0, 12));
+			if (n <= 5) {
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), p0);
+				return;
+			}
+			__m128i const
+				p1 = _mm_or_si128(_mm_srli_si128(p0, 1), _mm_slli_si128(p0, 14)),
+				p2 = _mm_or_si128(_mm_srli_si128(p0, 2), _mm_slli_si128(p0, 13));
+			byte* const end = dst + 3 * n;
+		#ifdef SIGMA_LIB_IMAGE_AVX2
+			if (n > 16) {
+				__m256i const
+					q0 = _mm256_set_m128i(p1, p0),
+					q1 = _mm256_set_m128i(p0, p2),
+					q2 = _mm256_set_m128i(p2, p1);
+				do {
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), q0);
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 32), q1);
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 64), q2);
+					dst += 96;
+				} while (dst < end);
+				return;
+			}
+		#endif
+			do {
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), p0);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 16), p1);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 32), p2);
+				dst += 48;
+			} while (dst < end);
+		#else
+			fill_exact(dst, px, n);
+		#endif
+		}
+
+		// same as fill() but doesn't write beyond the `n` pixels.
+		static void fill_exact(byte* dst, uint32_t px, int n)
+		{
+		#ifdef SIGMA_LIB_IMAGE_SSE2
+			// let the vector stores run over into the tail, which is written afterwards.
+			constexpr int tail = (overrun + 2) / 3;
+			if (n > tail) {
+				fill(dst, px, n - tail);
+				dst += 3 * (n - tail); n = tail;
+			}
+		#endif
+			for (; n > 0; n--, dst += 3) {
+				dst[0] = static_cast<byte>(px);
+				dst[1] = static_cast<byte>(px >> 8);
+				dst[2] = static_cast<byte>(px >> 16);
+			}
+		}
+
+	public:
+		// renders the `vb` area of `src` scaled to `vp`, only the part inside `clip`.
+		// `vp` and `clip` are in the destination coordinate, and the returned image
+		// covers `vp & clip`, which might be empty.
+		// each source pixel covers the span the grid lines are drawn at,
+		// the same as RasterCanvas::stretch_image(), as tests/raster_canvas.cpp checks.
+		// with `strips`, the output is split into bands at the boundaries of source rows,
+		// which are rendered in parallel to the identical result.
+		const ImageView& render(const ImageView& src, const Rect& vb, const Rect& vp, const Rect& clip,
+			StripPool* strips = nullptr)
+		{
+			auto const area = vp & clip;
+			int const w = vb.width(), h = vb.height();
+			if (area.is_empty() || w <= 0 || h <= 0) {
+				out.width = out.height = 0;
+				return out;
+			}
+
+			// allocate the output.
+			out.width = area.width(); out.height = area.height();
+			out.stride = ImageView::stride_of(out.width);
+			pool.tick();
+			out.bits = static_cast<byte*>(pool.allocate(out.stride * out.height + overrun));
+
+			// ranges relative to the view port.
+			int const X0 = area.left - vp.left, X1 = area.right - vp.left,
+				Y0 = area.top - vp.top, Y1 = area.bottom - vp.top;
+			auto const cs = cols.get(w, vp.width());
+			auto const rs = rows.get(h, vp.height());
+			if (out.bits == nullptr || cs == nullptr || rs == nullptr) {
+				// out of memory; draw nothing rather than write through null.
+				out.width = out.height = 0;
+				return out;
+			}
+
+			// the source columns that cover the output.
+			int const i0 = static_cast<int>(std::upper_bound(cs, cs + w + 1, X0) - cs) - 1,
+				i1 = static_cast<int>(std::lower_bound(cs, cs + w + 1, X1) - cs);
+
+			// the source rows that cover the output.
+			int const j0 = static_cast<int>(std::upper_bound(rs, rs + h + 1, Y0) - rs) - 1,
+				j1 = static_cast<int>(std::lower_bound(rs, rs + h + 1, Y1) - rs);
+
+			// rows are processed from the bottom, or the lowest address,
+			// so the vector stores running over will be overwritten later.
+			// the top row of a band must not run over into the band above, which might have been done.
+			auto const render_rows = [&](int j_lo, int j_hi, bool exact_top) {
+				for (int j = j_hi; --j >= j_lo;) {
+					int const y_lo = std::max(rs[j], Y0), y_hi = std::min(rs[j + 1], Y1);
+					if (y_lo >= y_hi) continue;
+
+					// expand the source row into the last row of the span.
+					const byte* s = src.row(vb.top + j) + 3 * (vb.left + i0);
+					byte* const d = out.row(y_hi - 1 - Y0);
+					for (int i = i0; i < i1; i++, s += 3) {
+						int const x_lo = std::max(cs[i], X0), x_hi = std::min(cs[i + 1], X1);
+						if (x_lo >= x_hi) continue;
+						bool const exact = exact_top && j == j_lo && 3 * static_cast<size_t>(x_hi - X0) + overrun > out.stride;
+						(exact ? fill_exact : fill)(
+							d + 3 * (x_lo - X0), s[0] | (s[1] << 8) | (s[2] << 16), x_hi - x_lo);
+					}
+
+					// duplicate the rest of the span.
+					for (int y = y_lo; y < y_hi - 1; y++)
+						std::memcpy(out.row(y - Y0), d, out.stride);
+				}
+			};
+
+			int const num_bands = strips == nullptr ? 1 :
+				std::clamp(std::min(4 * strips->threads(), (Y1 - Y0) / min_band_rows), 1, j1 - j0);
+			if (num_bands <= 1) render_rows(j0, j1, false);
+			else {
+				// split evenly by the output rows, rounded to the source rows.
+				auto const band_start = [&](int b) {
+					int const Y = Y0 + static_cast<int>(static_cast<int64_t>(Y1 - Y0) * b / num_bands);
+					return std::max(static_cast<int>(std::upper_bound(rs + j0, rs + j1, Y) - rs) - 1, j0);
+				};
+				strips->run(num_bands, [&](int b) {
+					int const j_lo = b == 0 ? j0 : band_start(b),
+						j_hi = b == num_bands - 1 ? j1 : band_start(b + 1);
+					if (j_lo < j_hi) render_rows(j_lo, j_hi, b > 0);
+				});
+			}
+			return out;
+		}
+
+		// releases the excess capacity of the output. the last output is kept.
+		void trim()
+		{
+			if (out.bits == nullptr) return;
+			pool.trim();
+			out.bits = static_cast<byte*>(pool.data());
+		}
+		void release()
+		{
+			pool.release();
+			cols.release(); rows.release();
+			out = {};
+		}
+	};
+}